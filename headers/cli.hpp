@@ -11,11 +11,15 @@ namespace cli {
 namespace po = boost::program_options;
 
 enum SelfIntersectionMode { NONE, BOTH, EMITTER, RECEIVER };
-enum BackFaceCullMode { ON, OFF };
-enum BlockingMode { NAIVE, BVH };
+enum BackFaceCullMode { ON, OFF, HIERARCHICAL };
+enum BlockingMode { NAIVE, BVH, BVH_PACKET };
 enum NumericMode { DAI, SAI };
 enum ComputeMode { CPU_N, GPU, GPU_N };
-enum PrecisionMode { SINGLE, DOUBLE };
+enum PrecisionMode { SINGLE, DOUBLE, EXTENDED, MIXED };
+enum BVHConstructionMode { SAMPLED, BINNED };
+enum BVHThreadingMode { SERIAL, TASKS };
+enum KernelMode { AUTO, SCALAR, VALIDATE };
+enum StorageMode { FULL, SYMMETRIC };
 
 //* -------------------- MAP SELF-INT INPUTS AND OUTPUTS -------------------- *//
 //* map self-intersection type input string to enum
@@ -39,26 +43,30 @@ boost::assign::map_list_of(
 static std::map<std::string, BackFaceCullMode> BACKFACECULL_INPUT_TO_ENUM =
 boost::assign::map_list_of(
   "ON", BackFaceCullMode::ON)(
-  "OFF", BackFaceCullMode::OFF);
+  "OFF", BackFaceCullMode::OFF)(
+  "HIERARCHICAL", BackFaceCullMode::HIERARCHICAL);
 
 //* map back face cull enum to output string
 static std::map<BackFaceCullMode, std::string> BACKFACECULL_ENUM_TO_OUTPUT =
 boost::assign::map_list_of(
   BackFaceCullMode::ON, "ON")(
-  BackFaceCullMode::OFF, "OFF");
+  BackFaceCullMode::OFF, "OFF")(
+  BackFaceCullMode::HIERARCHICAL, "HIERARCHICAL");
 
 //* -------------------- MAP BLOCKING TYPE INPUTS AND OUTPUTS -------------------- *//
 //* map blocking type input string to enum
 static std::map<std::string, BlockingMode> BLOCKING_TYPE_INPUT_TO_ENUM =
 boost::assign::map_list_of(
   "NAIVE", BlockingMode::NAIVE)(
-  "BVH", BlockingMode::BVH);
+  "BVH", BlockingMode::BVH)(
+  "BVH_PACKET", BlockingMode::BVH_PACKET);
 
 //* map blocking type enum to output string
 static std::map<BlockingMode, std::string> BLOCKING_TYPE_ENUM_TO_OUTPUT =
 boost::assign::map_list_of(
   BlockingMode::NAIVE, "NAIVE")(
-    BlockingMode::BVH, "BVH");
+    BlockingMode::BVH, "BVH")(
+    BlockingMode::BVH_PACKET, "BVH_PACKET");
 
 //* -------------------- MAP NUMERICS INPUTS AND OUTPUTS -------------------- *//
 //* map numerics input string to enum
@@ -93,13 +101,71 @@ boost::assign::map_list_of(
 static std::map<std::string, PrecisionMode> PRECISION_INPUT_TO_ENUM =
 boost::assign::map_list_of(
   "SINGLE", PrecisionMode::SINGLE)(
-  "DOUBLE", PrecisionMode::DOUBLE);
+  "DOUBLE", PrecisionMode::DOUBLE)(
+  "EXTENDED", PrecisionMode::EXTENDED)(
+  "MIXED", PrecisionMode::MIXED);
 
 //* map precision enum to output string
 static std::map<PrecisionMode, std::string> PRECISION_ENUM_TO_OUTPUT =
 boost::assign::map_list_of(
   PrecisionMode::SINGLE, "SINGLE")(
-  PrecisionMode::DOUBLE, "DOUBLE");
+  PrecisionMode::DOUBLE, "DOUBLE")(
+  PrecisionMode::EXTENDED, "EXTENDED")(
+  PrecisionMode::MIXED, "MIXED");
+
+//* -------------------- MAP BVH CONSTRUCTION INPUTS AND OUTPUTS -------------------- *//
+//* map bvh construction input string to enum
+static std::map<std::string, BVHConstructionMode> BVH_CONSTRUCTION_INPUT_TO_ENUM =
+boost::assign::map_list_of(
+  "SAMPLED", BVHConstructionMode::SAMPLED)(
+  "BINNED", BVHConstructionMode::BINNED);
+
+//* map bvh construction enum to output string
+static std::map<BVHConstructionMode, std::string> BVH_CONSTRUCTION_ENUM_TO_OUTPUT =
+boost::assign::map_list_of(
+  BVHConstructionMode::SAMPLED, "SAMPLED")(
+  BVHConstructionMode::BINNED, "BINNED");
+
+//* -------------------- MAP BVH THREADING INPUTS AND OUTPUTS -------------------- *//
+//* map bvh threading input string to enum
+static std::map<std::string, BVHThreadingMode> BVH_THREADING_INPUT_TO_ENUM =
+boost::assign::map_list_of(
+  "SERIAL", BVHThreadingMode::SERIAL)(
+  "TASKS", BVHThreadingMode::TASKS);
+
+//* map bvh threading enum to output string
+static std::map<BVHThreadingMode, std::string> BVH_THREADING_ENUM_TO_OUTPUT =
+boost::assign::map_list_of(
+  BVHThreadingMode::SERIAL, "SERIAL")(
+  BVHThreadingMode::TASKS, "TASKS");
+
+//* -------------------- MAP KERNEL INPUTS AND OUTPUTS -------------------- *//
+//* map kernel input string to enum, shared by the BVH leaf and view factor kernel options
+static std::map<std::string, KernelMode> KERNEL_INPUT_TO_ENUM =
+boost::assign::map_list_of(
+  "AUTO", KernelMode::AUTO)(
+  "SCALAR", KernelMode::SCALAR)(
+  "VALIDATE", KernelMode::VALIDATE);
+
+//* map kernel enum to output string
+static std::map<KernelMode, std::string> KERNEL_ENUM_TO_OUTPUT =
+boost::assign::map_list_of(
+  KernelMode::AUTO, "AUTO")(
+  KernelMode::SCALAR, "SCALAR")(
+  KernelMode::VALIDATE, "VALIDATE");
+
+//* -------------------- MAP STORAGE INPUTS AND OUTPUTS -------------------- *//
+//* map matrix storage input string to enum
+static std::map<std::string, StorageMode> STORAGE_INPUT_TO_ENUM =
+boost::assign::map_list_of(
+  "FULL", StorageMode::FULL)(
+  "SYMMETRIC", StorageMode::SYMMETRIC);
+
+//* map matrix storage enum to output string
+static std::map<StorageMode, std::string> STORAGE_ENUM_TO_OUTPUT =
+boost::assign::map_list_of(
+  StorageMode::FULL, "FULL")(
+  StorageMode::SYMMETRIC, "SYMMETRIC");
 
 //* -------------------- NOTIFIERS -------------------- *//
 void checkSelfIntersectionType(const std::string &self_int_type) {
@@ -150,6 +216,54 @@ void checkPrecision(const std::string &precision) {
   std::cout << "\t\t> [VALID]" << '\n';
 }
 
+void checkBVHConstruction(const std::string &bvh_construction) {
+  std::cout << "[CHECK] Checking BVH Construction Argument";
+  if (!BVH_CONSTRUCTION_INPUT_TO_ENUM.count(bvh_construction)) {
+    throw po::error("\t> [ERROR] BVH construction method not recognized: " + bvh_construction);
+  }
+  std::cout << "\t> [VALID]" << '\n';
+}
+
+void checkBVHThreading(const std::string &bvh_threading) {
+  std::cout << "[CHECK] Checking BVH Threading Argument";
+  if (!BVH_THREADING_INPUT_TO_ENUM.count(bvh_threading)) {
+    throw po::error("\t> [ERROR] BVH threading mode not recognized: " + bvh_threading);
+  }
+  std::cout << "\t> [VALID]" << '\n';
+}
+
+void checkLeafKernel(const std::string &leaf_kernel) {
+  std::cout << "[CHECK] Checking Leaf Kernel Argument";
+  if (!KERNEL_INPUT_TO_ENUM.count(leaf_kernel)) {
+    throw po::error("\t> [ERROR] Leaf kernel mode not recognized: " + leaf_kernel);
+  }
+  std::cout << "\t> [VALID]" << '\n';
+}
+
+void checkViewFactorKernel(const std::string &vf_kernel) {
+  std::cout << "[CHECK] Checking View Factor Kernel Argument";
+  if (!KERNEL_INPUT_TO_ENUM.count(vf_kernel)) {
+    throw po::error("\t> [ERROR] View factor kernel mode not recognized: " + vf_kernel);
+  }
+  std::cout << "\t> [VALID]" << '\n';
+}
+
+void checkStorage(const std::string &storage) {
+  std::cout << "[CHECK] Checking Matrix Storage Argument";
+  if (!STORAGE_INPUT_TO_ENUM.count(storage)) {
+    throw po::error("\t> [ERROR] Matrix storage mode not recognized: " + storage);
+  }
+  std::cout << "\t> [VALID]" << '\n';
+}
+
+void checkWeldTolerance(const double &weld) {
+  std::cout << "[CHECK] Checking Weld Tolerance Argument";
+  if (!(weld >= 0.0)) {
+    throw po::error("\t> [ERROR] Weld tolerance must not be negative: " + std::to_string(weld));
+  }
+  std::cout << "\t> [VALID]" << '\n';
+}
+
 //* -------------------- DEFINE PROGRAM OPTIONS -------------------- *//
 po::options_description getOptions() {
 po::options_description options("OpenViewFactor Options",500,250);
@@ -169,22 +283,49 @@ options.add_options()
     "-m <LOG OUTPUT FILEPATH> \n[--+--] Filepath for command-line log output (defaults to 'NONE')")
   ("matrixout,m",
     po::value<std::string>()->default_value(std::string("NONE")),
-    "-m <MATRIX OUTPUT FILEPATH> \n[--+--] Filepath for nonzero element-wise view factor map output (defaults to 'NONE')")
+    "-m <MATRIX OUTPUT FILEPATH> \n[--+--] Filepath for binary sparse element-wise view factor matrix output, written as <FILEPATH>.ovf (defaults to 'NONE')")
   ("graphicout,g",
     po::value<std::vector<std::string>>()->default_value(std::vector<std::string>({std::string("NONE")}), "NONE")->multitoken(),
     "-g <GRAPHIC OUTPUT FILEPATH> \n[--+--] Filename for Paraview unstructured grid (.vtu) output (defaults to 'emitter_out')")
   ("bvhout,b",
     po::value<std::string>()->default_value(std::string(std::string("NONE"))),
     "-b <BLOCKER BVH OUTPUT FILEPATH> \n[--+--] Filename for Paraview unstructured grid (.vtu) output of the blocker BVH structure (skips by default)")
+  ("bvhcache,y",
+    po::value<std::string>()->default_value(std::string("NONE")),
+    "-y <BVH CACHE FILEPATH> \n[--+--] Blocker BVH cache, loaded instead of building when it was written for the same blockers, BVH construction and precision and rewritten otherwise, as <FILEPATH>.bvh (defaults to 'NONE')")
+  ("weld,w",
+    po::value<double>()->default_value(0.0)->notifier(&checkWeldTolerance),
+    "-w <WELD TOLERANCE> \n[--+--] Blocking mesh vertices closer than this are merged and triangles collapsing under the merge are dropped, 0 only merges identical vertices (defaults to 0)")
+  ("viscache,z",
+    po::value<std::string>()->default_value(std::string("NONE")),
+    "-z <VISIBILITY CACHE FILEPATH> \n[--+--] Blocking results cache of 2 bits per element pair, reused when it was written for the same meshes, blockers and blocking type and rewritten after blocking, as <FILEPATH>.vis, not kept while streaming emitter tiles (defaults to 'NONE')")
   ("selfint,s",
     po::value<std::string>()->default_value("NONE")->notifier(&checkSelfIntersectionType),
     "-s <NONE/EMITTER/RECEIVER/BOTH> \n[--+--] Determines which input mesh(es) are included in evaluating obstruction (defaults to NONE)")
   ("backfacecull,f",
     po::value<std::string>()->default_value("ON")->notifier(&checkBackFaceCull),
-    "-f <ON/OFF> \n[--+--] Determines whether to execute back face culling (defaults to ON)")
+    "-f <ON/OFF/HIERARCHICAL> \n[--+--] Determines whether to execute back face culling, pair by pair or deciding whole element clusters first (defaults to ON)")
   ("blockingtype,t",
     po::value<std::string>()->default_value("NAIVE")->notifier(&checkBlockingType),
-    "-t <BVH/NAIVE> \n[--+--] Determines which type of blocking to utilize (defaults to NAIVE)")
+    "-t <BVH/BVH_PACKET/NAIVE> \n[--+--] Determines which type of blocking to utilize, BVH_PACKET traces rays from each emitter through the BVH in packets (defaults to NAIVE)")
+  ("bvhbuild,u",
+    po::value<std::string>()->default_value("SAMPLED")->notifier(&checkBVHConstruction),
+    "-u <SAMPLED/BINNED> \n[--+--] BVH construction method, sampled split planes or binned surface area heuristic (defaults to SAMPLED)")
+  ("bvhthreading,q",
+    po::value<std::string>()->default_value("TASKS")->notifier(&checkBVHThreading),
+    "-q <SERIAL/TASKS> \n[--+--] Build independent BVH subtrees serially or as concurrent OpenMP tasks (defaults to TASKS)")
+  ("leafkernel,k",
+    po::value<std::string>()->default_value("AUTO")->notifier(&checkLeafKernel),
+    "-k <AUTO/SCALAR/VALIDATE> \n[--+--] BVH leaf intersection kernel, widest SIMD the CPU supports, scalar only, or SIMD checked against scalar (defaults to AUTO)")
+  ("emittertile,e",
+    po::value<unsigned int>()->default_value(0),
+    "-e <EMITTERS PER TILE> \n[--+--] Solve emitters in tiles of this many rows, streaming each finished tile to the matrix output so memory stays bounded by the tile (defaults to 0, every emitter at once)")
+  ("vfkernel,a",
+    po::value<std::string>()->default_value("AUTO")->notifier(&checkViewFactorKernel),
+    "-a <AUTO/SCALAR/VALIDATE> \n[--+--] View factor integration kernel, widest SIMD the CPU supports, scalar only, or SIMD checked against scalar (defaults to AUTO)")
+  ("storage,r",
+    po::value<std::string>()->default_value("FULL")->notifier(&checkStorage),
+    "-r <FULL/SYMMETRIC> \n[--+--] View factor matrix storage, every pair, or for a single input mesh only the pairs i < j with the rest following from reciprocity (defaults to FULL)")
   ("numerics,n",
     po::value<std::string>()->default_value("DAI")->notifier(&checkNumerics),
     "-n <DAI/SAI> \n[--+--] Numeric integration method (defaults to DAI)")
@@ -193,7 +334,7 @@ options.add_options()
     "-c <CPU_N/GPU/GPU_N> \n[--+--] Compute backend (defaults to CPU_N)")
   ("precision,p",
     po::value<std::string>()->default_value("DOUBLE")->notifier(&checkPrecision),
-    "-p <SINGLE/DOUBLE> \n[--+--] Floating point precision (defaults to SINGLE)");
+    "-p <SINGLE/DOUBLE/EXTENDED/MIXED> \n[--+--] Floating point precision, float, double, long double, or float geometry with double integration (defaults to DOUBLE)");
 return options;
 }
 
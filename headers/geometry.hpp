@@ -1,4 +1,5 @@
 #include "all_headers.hpp"
+#include "mapped_file.hpp"
 
 #pragma once
 
@@ -83,6 +84,45 @@ template <typename T> class ray {
   ray(v3<T> O, v3<T> D) : _O(O), _D(D), _invD(v3<T>(1.0 / D[0], 1.0 / D[1], 1.0 / D[2])), _t(INFINITY) {}
 };
 
+//* ray packet, rays leaving one origin together with the range of their inverse directions
+const unsigned int PACKET_SIZE = 16;
+
+template <typename T> class rayPacket {
+  public:
+  v3<T> _O;
+  std::array<ray<T>, PACKET_SIZE> _rays;
+  std::array<T, PACKET_SIZE> _lengths;
+  T _t_max;
+  unsigned int _N;
+  std::array<T, 3> _invD_min, _invD_max;
+  std::array<bool, 3> _bounded;
+
+  rayPacket(v3<T> O) : _O(O), _t_max(0.0), _N(0) {
+    _invD_min.fill(INFINITY);
+    _invD_max.fill(-INFINITY);
+    _bounded.fill(true);
+  }
+
+  //* an axis only bounds the packet while every inverse direction on it is finite and of one sign
+  void add(v3<T> D, T length) {
+    _rays[_N] = ray<T>(_O, D);
+    _rays[_N]._t = length;
+    _lengths[_N] = length;
+    _t_max = std::max(_t_max, length);
+    for (int axis = 0; axis < 3; axis++) {
+      T inv = _rays[_N]._invD[axis];
+      if (!std::isfinite(inv) || (_N > 0 && std::signbit(inv) != std::signbit(_invD_min[axis]))) {
+        _bounded[axis] = false;
+      }
+      _invD_min[axis] = std::min(_invD_min[axis], inv);
+      _invD_max[axis] = std::max(_invD_max[axis], inv);
+    }
+    _N++;
+  }
+
+  unsigned int fullMask() const { return (1u << _N) - 1; }
+};
+
 
 
 //* tri
@@ -169,6 +209,9 @@ template <typename T> T triAspectRatio(tri<T> t) {
 
 
 //* Mesh
+//* bulk mesh copies below this many triangles or corners stay on the calling thread
+const size_t MESH_PARALLEL_SIZE = 4096;
+
 template <typename T> class mesh {
   public:
   std::vector<T> _p;
@@ -179,6 +222,8 @@ template <typename T> class mesh {
     _p = p;
     _c = c;
   }
+  //* the same vertices and connectivity in another floating point type
+  template <typename S> mesh(const mesh<S>* other) : _p(other->_p.begin(), other->_p.end()), _c(other->_c) {}
   
   tri<T> operator[](unsigned int i) const {
     std::array<T,9> points;
@@ -189,13 +234,15 @@ template <typename T> class mesh {
     return t;
   }
 
-  mesh<T> operator[](std::vector<unsigned int> indices) const {
-    mesh<T> sub_mesh;
-    std::vector<tri<T>> triangles(indices.size());
-    for (int i = 0; i < indices.size(); i++) {
-      triangles[i] = (*this)[indices[i]];
+  //* the selected triangles each with their own three vertices, written straight into a mesh sized up front
+  mesh<T> operator[](const std::vector<unsigned int>& indices) const {
+    mesh<T> sub_mesh(indices.size());
+    #pragma omp parallel for if(indices.size() >= MESH_PARALLEL_SIZE)
+    for (long long i = 0; i < (long long)indices.size(); i++) {
+      tri<T> t = (*this)[indices[i]];
+      std::copy(t._p.begin(), t._p.end(), sub_mesh._p.begin() + 9 * i);
+      std::iota(sub_mesh._c.begin() + 3 * i, sub_mesh._c.begin() + 3 * i + 3, 3 * i);
     }
-    sub_mesh + triangles;
     return sub_mesh;
   }
 
@@ -210,16 +257,33 @@ template <typename T> class mesh {
     return *this;
   }
 
-  mesh<T>& operator+(std::vector<tri<T>> triangles) {
-    for (auto el : triangles) {
-      (*this)+el;
+  //* every triangle gets its own three vertices, sized once and copied in place
+  mesh<T>& operator+(const std::vector<tri<T>>& triangles) {
+    size_t first_vertex = _p.size() / 3;
+    size_t first_corner = _c.size();
+    _p.resize(_p.size() + 9 * triangles.size());
+    _c.resize(_c.size() + 3 * triangles.size());
+    #pragma omp parallel for if(triangles.size() >= MESH_PARALLEL_SIZE)
+    for (long long i = 0; i < (long long)triangles.size(); i++) {
+      std::copy(triangles[i]._p.begin(), triangles[i]._p.end(), _p.begin() + 3 * first_vertex + 9 * i);
+      std::iota(_c.begin() + first_corner + 3 * i, _c.begin() + first_corner + 3 * i + 3, first_vertex + 3 * i);
     }
     return *this;
   }
 
-  mesh<T>& operator+(mesh<T>* m) {
-    for (int i = 0; i < m->size(); i++) {
-      (*this) + (*m)[i];
+  //* appends the vertices and connectivity of m as they are, so vertices shared in m stay shared
+  mesh<T>& operator+(const mesh<T>* m) {
+    if (m == this) {
+      mesh<T> copy = *m;
+      return (*this) + &copy;
+    }
+    size_t vertex_offset = _p.size() / 3;
+    size_t first_corner = _c.size();
+    _p.insert(_p.end(), m->_p.begin(), m->_p.end());
+    _c.resize(first_corner + m->_c.size());
+    #pragma omp parallel for if(m->_c.size() >= MESH_PARALLEL_SIZE)
+    for (long long k = 0; k < (long long)m->_c.size(); k++) {
+      _c[first_corner + k] = m->_c[k] + vertex_offset;
     }
     return *this;
   }
@@ -261,6 +325,293 @@ template <typename T> std::vector<tri<T>> allTriangles(mesh<T>* m) {
   return triangles;
 }
 
+//* one mesh holding every part in order, reserved once so appending never reallocates
+template <typename T> mesh<T> combineMeshes(const std::vector<const mesh<T>*>& parts) {
+  size_t num_coordinates = 0, num_corners = 0;
+  for (const mesh<T>* part : parts) {
+    num_coordinates += part->_p.size();
+    num_corners += part->_c.size();
+  }
+  mesh<T> combined;
+  combined._p.reserve(num_coordinates);
+  combined._c.reserve(num_corners);
+  for (const mesh<T>* part : parts) {
+    combined + part;
+  }
+  return combined;
+}
+
+//* spatial hash over the vertices of a mesh, cells one tolerance wide so any vertex within the tolerance of another
+//* sits in one of the 27 cells around it, or one cell per exact position when the tolerance is zero
+template <typename T> class vertexGrid {
+  public:
+  const mesh<T>* _m;
+  T _tolerance;
+  uint64_t _mask;
+  std::vector<size_t> _bucket_offsets;
+  std::vector<size_t> _vertices;
+
+  vertexGrid(const mesh<T>* m, T tolerance) : _m(m), _tolerance(tolerance) {
+    size_t num_vertices = m->_p.size() / 3;
+    size_t num_buckets = 1;
+    while (num_buckets < num_vertices) { num_buckets *= 2; }
+    _mask = num_buckets - 1;
+
+    std::vector<uint64_t> buckets(num_vertices);
+    #pragma omp parallel for
+    for (long long v = 0; v < (long long)num_vertices; v++) {
+      buckets[v] = bucketOf(cellOf(v));
+    }
+
+    //* counting sort keeps every bucket in ascending vertex order
+    _bucket_offsets.assign(num_buckets + 1, 0);
+    for (size_t v = 0; v < num_vertices; v++) { _bucket_offsets[buckets[v] + 1]++; }
+    std::inclusive_scan(_bucket_offsets.begin() + 1, _bucket_offsets.end(), _bucket_offsets.begin() + 1);
+    std::vector<size_t> cursors(_bucket_offsets.begin(), _bucket_offsets.end() - 1);
+    _vertices.resize(num_vertices);
+    for (size_t v = 0; v < num_vertices; v++) { _vertices[ cursors[buckets[v]]++ ] = v; }
+  }
+
+  bool exact() const { return !(_tolerance > 0); }
+
+  std::array<double,3> cellOf(size_t v) const {
+    std::array<double,3> cell;
+    for (int k = 0; k < 3; k++) {
+      T x = _m->_p[3*v + k] + (T)0.0;
+      cell[k] = exact() ? (double)x : std::floor((double)(x / _tolerance));
+    }
+    return cell;
+  }
+
+  uint64_t bucketOf(const std::array<double,3>& cell) const {
+    uint64_t bits[3];
+    std::memcpy(bits, cell.data(), sizeof(bits));
+    uint64_t hash = bits[0] * 0x9E3779B97F4A7C15ull;
+    hash ^= bits[1] * 0xC2B2AE3D27D4EB4Full;
+    hash ^= bits[2] * 0x165667B19E3779F9ull;
+    return ( (hash ^ (hash >> 29)) & _mask );
+  }
+
+  bool coincident(size_t a, size_t b) const {
+    const T* p = _m->_p.data();
+    if (exact()) {
+      return ( p[3*a] == p[3*b] && p[3*a + 1] == p[3*b + 1] && p[3*a + 2] == p[3*b + 2] );
+    }
+    T dx = p[3*a] - p[3*b], dy = p[3*a + 1] - p[3*b + 1], dz = p[3*a + 2] - p[3*b + 2];
+    return ( dx*dx + dy*dy + dz*dz <= _tolerance * _tolerance );
+  }
+
+  //* the lowest vertex coincident with v, v itself when none comes before it
+  size_t lowest(size_t v) const {
+    size_t found = v;
+    std::array<double,3> cell = cellOf(v);
+    int reach = exact() ? 0 : 1;
+    for (int dx = -reach; dx <= reach; dx++) {
+      for (int dy = -reach; dy <= reach; dy++) {
+        for (int dz = -reach; dz <= reach; dz++) {
+          uint64_t bucket = bucketOf({ cell[0] + dx, cell[1] + dy, cell[2] + dz });
+          for (size_t k = _bucket_offsets[bucket]; k < _bucket_offsets[bucket + 1]; k++) {
+            size_t u = _vertices[k];
+            if (u >= found) { break; }
+            if (coincident(u, v)) { found = u; }
+          }
+        }
+      }
+    }
+    return found;
+  }
+};
+
+class weldStats {
+  public:
+  size_t _vertices_before;
+  size_t _vertices_after;
+  size_t _collapsed;
+
+  weldStats() : _vertices_before(0), _vertices_after(0), _collapsed(0) {}
+};
+
+//* merges vertices within tolerance of each other onto the lowest of them and drops the triangles that collapse,
+//* vertices and triangles keep their relative order whatever the thread count
+template <typename T> weldStats weldVertices(mesh<T>* m, T tolerance) {
+  weldStats stats;
+  size_t num_vertices = m->_p.size() / 3;
+  stats._vertices_before = num_vertices;
+
+  vertexGrid<T> grid(m, tolerance);
+  std::vector<size_t> representatives(num_vertices);
+  #pragma omp parallel for schedule(dynamic, 1024)
+  for (long long v = 0; v < (long long)num_vertices; v++) {
+    representatives[v] = grid.lowest(v);
+  }
+  //* a tolerance chain a - b - c follows b down to a, representatives only ever point to lower vertices
+  std::vector<size_t> roots(num_vertices);
+  std::vector<size_t> vertex_ids(num_vertices);
+  #pragma omp parallel for
+  for (long long v = 0; v < (long long)num_vertices; v++) {
+    size_t r = v;
+    while (representatives[r] != r) { r = representatives[r]; }
+    roots[v] = r;
+    vertex_ids[v] = (r == v) ? 1 : 0;
+  }
+  stats._vertices_after = std::reduce(vertex_ids.begin(), vertex_ids.end(), (size_t)0);
+  std::exclusive_scan(vertex_ids.begin(), vertex_ids.end(), vertex_ids.begin(), (size_t)0);
+
+  std::vector<T> points(3 * stats._vertices_after);
+  #pragma omp parallel for
+  for (long long v = 0; v < (long long)num_vertices; v++) {
+    if (roots[v] != v) { continue; }
+    std::copy(m->_p.begin() + 3*v, m->_p.begin() + 3*v + 3, points.begin() + 3 * vertex_ids[v]);
+  }
+
+  size_t num_triangles = m->size();
+  std::vector<size_t> kept(num_triangles);
+  #pragma omp parallel for
+  for (long long i = 0; i < (long long)num_triangles; i++) {
+    size_t a = roots[m->_c[3*i]], b = roots[m->_c[3*i + 1]], c = roots[m->_c[3*i + 2]];
+    kept[i] = (a == b || b == c || c == a) ? 0 : 1;
+  }
+  size_t num_kept = std::reduce(kept.begin(), kept.end(), (size_t)0);
+  stats._collapsed = num_triangles - num_kept;
+  std::vector<size_t> destinations(num_triangles);
+  std::exclusive_scan(kept.begin(), kept.end(), destinations.begin(), (size_t)0);
+
+  std::vector<size_t> connectivity(3 * num_kept);
+  #pragma omp parallel for
+  for (long long i = 0; i < (long long)num_triangles; i++) {
+    if (!kept[i]) { continue; }
+    for (int k = 0; k < 3; k++) {
+      connectivity[3 * destinations[i] + k] = vertex_ids[ roots[m->_c[3*i + k]] ];
+    }
+  }
+
+  m->_p = std::move(points);
+  m->_c = std::move(connectivity);
+  return stats;
+}
+
+//* per-element quantities the solver stages read, computed once per mesh and split into one array per component
+template <typename T> class meshData {
+  public:
+  std::vector<T> _Cx, _Cy, _Cz;
+  std::vector<T> _Nx, _Ny, _Nz;
+  std::vector<T> _area;
+  std::array<std::vector<T>, 9> _p;
+
+  meshData() {}
+  meshData(size_t num_triangles) :
+    _Cx(num_triangles), _Cy(num_triangles), _Cz(num_triangles),
+    _Nx(num_triangles), _Ny(num_triangles), _Nz(num_triangles),
+    _area(num_triangles) {
+    for (auto& component : _p) { component.resize(num_triangles); }
+  }
+  meshData(mesh<T>* m) : meshData(m->size()) {
+    #pragma omp parallel for
+    for (int triangle = 0; triangle < m->size(); triangle++) {
+      set(triangle, (*m)[triangle]);
+    }
+  }
+  //* the same elements in another precision, centroids, normals and areas are recomputed from the converted vertices
+  template <typename S> meshData(const meshData<S>* other) : meshData(other->size()) {
+    #pragma omp parallel for
+    for (int triangle = 0; triangle < other->size(); triangle++) {
+      tri<T> t;
+      for (int j = 0; j < 9; j++) { t._p[j] = (T)other->_p[j][triangle]; }
+      set(triangle, t);
+    }
+  }
+
+  size_t size() const { return _area.size(); }
+
+  v3<T> centroid(size_t i) const { return v3<T>(_Cx[i], _Cy[i], _Cz[i]); }
+  v3<T> normal(size_t i) const { return v3<T>(_Nx[i], _Ny[i], _Nz[i]); }
+  v3<T> vertex(size_t i, unsigned int point) const { return v3<T>(_p[3*point + 0][i], _p[3*point + 1][i], _p[3*point + 2][i]); }
+
+  void set(size_t i, tri<T> t) {
+    v3<T> c = geometry::centroid(t);
+    v3<T> n = geometry::normal(t);
+    _Cx[i] = c._x; _Cy[i] = c._y; _Cz[i] = c._z;
+    _Nx[i] = n._x; _Ny[i] = n._y; _Nz[i] = n._z;
+    _area[i] = geometry::area(t);
+    for (int j = 0; j < 9; j++) { _p[j][i] = t._p[j]; }
+  }
+
+  //* copy of the elements [first, last), for solving a block of emitters on its own
+  meshData<T> slice(size_t first, size_t last) const {
+    meshData<T> s;
+    auto copy = [&](const std::vector<T>& from, std::vector<T>& to) { to.assign(from.begin() + first, from.begin() + last); };
+    copy(_Cx, s._Cx); copy(_Cy, s._Cy); copy(_Cz, s._Cz);
+    copy(_Nx, s._Nx); copy(_Ny, s._Ny); copy(_Nz, s._Nz);
+    copy(_area, s._area);
+    for (int j = 0; j < 9; j++) { copy(_p[j], s._p[j]); }
+    return s;
+  }
+};
+
+//* bounding box of the centroids and normal cone of the elements [_first, _last), every normal lies within
+//* _spread of the unit _axis. an inner cluster's children split its range in half, leaves have no children
+template <typename T> class elementCluster {
+  public:
+  v3<T> _min, _max;
+  v3<T> _axis;
+  T _spread;
+  unsigned int _first, _last;
+  unsigned int _left, _right;
+
+  elementCluster() : _min(v3<T>(INFINITY, INFINITY, INFINITY)), _max(v3<T>(-INFINITY, -INFINITY, -INFINITY)), _spread(0.0), _first(0), _last(0), _left(0), _right(0) {}
+
+  bool isLeaf() const { return _left == 0; }
+};
+
+template <typename T> elementCluster<T> clusterBounds(const meshData<T>* data, unsigned int first, unsigned int last) {
+  elementCluster<T> c;
+  c._first = first;
+  c._last = last;
+  v3<T> normal_sum;
+  for (unsigned int i = first; i < last; i++) {
+    c._min = vectorElementsMinima(c._min, data->centroid(i));
+    c._max = vectorElementsMaxima(c._max, data->centroid(i));
+    normal_sum = normal_sum + data->normal(i);
+  }
+  //* opposing normals leave no axis, a zero axis with spread 1 still bounds them correctly
+  T length = magnitude(normal_sum);
+  c._axis = (length > 0.0) ? scale(normal_sum, (T)1.0 / length) : v3<T>();
+  for (unsigned int i = first; i < last; i++) {
+    c._spread = std::max(c._spread, magnitude(data->normal(i) - c._axis));
+  }
+  return c;
+}
+
+const unsigned int CLUSTER_LEAF_SIZE = 32;
+
+//* cluster hierarchy over element index ranges, elements keep their order so an accepted cluster is a
+//* contiguous run of matrix columns
+template <typename T> class clusterTree {
+  public:
+  std::vector<elementCluster<T>> _clusters;
+
+  clusterTree() {}
+  clusterTree(const meshData<T>* data) {
+    if (data->size() > 0) {
+      build(data, 0, data->size());
+    }
+  }
+
+  private:
+  unsigned int build(const meshData<T>* data, unsigned int first, unsigned int last) {
+    unsigned int index = _clusters.size();
+    _clusters.push_back(clusterBounds(data, first, last));
+    if (last - first > CLUSTER_LEAF_SIZE) {
+      unsigned int middle = first + (last - first) / 2;
+      unsigned int left = build(data, first, middle);
+      unsigned int right = build(data, middle, last);
+      _clusters[index]._left = left;
+      _clusters[index]._right = right;
+    }
+    return index;
+  }
+};
+
 template <typename T> std::vector<T> meshSkewness(mesh<T>* m) {
   std::vector<T> skewnesses(m->size());
   for (int triangle = 0; triangle < m->size(); triangle++) {
@@ -285,29 +636,168 @@ template <typename T> std::vector<T> meshAspectRatio(mesh<T>* m) {
   return aspect_ratio;
 }
 
-template <typename T> mesh<T> removeDegenerateElements(mesh<T>* m) {
+template <typename T> bool isDegenerate(tri<T> t) {
+  return ( std::isinf(triAspectRatio(t)) || std::isnan(triSkewness(t)) );
+}
+
+template <typename T> mesh<T> removeDegenerateElements(mesh<T>* m, unsigned int* num_degenerate = nullptr) {
   std::vector<unsigned int> good_elements(m->size());
   std::iota(good_elements.begin(), good_elements.end(), 0);
   for (int i = 0; i < m->size(); i++) {
-    if ( std::isinf(triAspectRatio((*m)[i])) || std::isnan(triSkewness((*m)[i])) ) {
+    if ( isDegenerate((*m)[i]) ) {
       good_elements[i] = m->size();
     }
   }
   auto it = std::remove(good_elements.begin(), good_elements.end(), m->size());
-
-  std::cout << "[TEMPORARY] Removing " << std::distance(it, good_elements.end()) << " degenerate elements\n";
-
+  if (num_degenerate != nullptr) { *num_degenerate = std::distance(it, good_elements.end()); }
   good_elements.erase(it, good_elements.end());
   mesh<T> new_mesh = (*m)[good_elements];
   return new_mesh;
 }
 
-template <typename T> mesh<T> getMesh(const std::string& filename) {
+//* binary STL: an 80 byte header, the triangle count, then 50 byte records of normal, three vertices and attribute
+const size_t STL_HEADER_BYTES = 84;
+const size_t STL_RECORD_BYTES = 50;
+
+//* a file is binary exactly when its size matches the count it declares, ASCII files starting with "solid" never do
+inline bool isBinarySTL(const io::mappedFile* file) {
+  if (file->size() < STL_HEADER_BYTES) { return false; }
+  uint32_t num_triangles;
+  std::memcpy(&num_triangles, file->data() + 80, sizeof(uint32_t));
+  return ( file->size() == STL_HEADER_BYTES + (size_t)num_triangles * STL_RECORD_BYTES );
+}
+
+//* concurrent exact deduplication of corner positions, every distinct position keeps the lowest corner holding it so
+//* vertices come out in the order a serial first-seen pass would give them
+class vertexTable {
+  public:
+  static const uint32_t EMPTY = 0xFFFFFFFF;
+
+  std::vector<std::atomic<uint32_t>> _slots;
+  uint64_t _mask;
+  const float* _positions;
+
+  vertexTable(const float* positions, size_t num_corners) : _positions(positions) {
+    size_t num_slots = 2;
+    while (num_slots < 2 * num_corners) { num_slots *= 2; }
+    _slots = std::vector<std::atomic<uint32_t>>(num_slots);
+    for (auto& slot : _slots) { slot.store(EMPTY, std::memory_order_relaxed); }
+    _mask = num_slots - 1;
+  }
+
+  uint64_t slotOf(uint32_t corner) const {
+    uint32_t bits[3];
+    std::memcpy(bits, _positions + 3 * (size_t)corner, sizeof(bits));
+    uint64_t hash = (uint64_t)bits[0] * 0x9E3779B97F4A7C15ull;
+    hash ^= (uint64_t)bits[1] * 0xC2B2AE3D27D4EB4Full;
+    hash ^= (uint64_t)bits[2] * 0x165667B19E3779F9ull;
+    return ( (hash ^ (hash >> 29)) & _mask );
+  }
+  bool samePosition(uint32_t a, uint32_t b) const {
+    return ( std::memcmp(_positions + 3 * (size_t)a, _positions + 3 * (size_t)b, 3 * sizeof(float)) == 0 );
+  }
+
+  void insert(uint32_t corner) {
+    uint64_t slot = slotOf(corner);
+    while (true) {
+      uint32_t held = _slots[slot].load(std::memory_order_relaxed);
+      if (held == EMPTY) {
+        if (_slots[slot].compare_exchange_weak(held, corner, std::memory_order_relaxed)) { return; }
+        continue;
+      }
+      if (samePosition(held, corner)) {
+        while (corner < held && !_slots[slot].compare_exchange_weak(held, corner, std::memory_order_relaxed)) {}
+        return;
+      }
+      slot = (slot + 1) & _mask;
+    }
+  }
+
+  //* the lowest corner sharing this corner's position, only valid once every corner is inserted
+  uint32_t first(uint32_t corner) const {
+    uint64_t slot = slotOf(corner);
+    while (true) {
+      uint32_t held = _slots[slot].load(std::memory_order_relaxed);
+      if (samePosition(held, corner)) { return held; }
+      slot = (slot + 1) & _mask;
+    }
+  }
+};
+
+//* parses the mapped records in parallel, drops degenerate triangles while parsing and merges coincident vertices
+template <typename T> mesh<T> readBinarySTL(const io::mappedFile* file, unsigned int* num_degenerate = nullptr) {
+  uint32_t num_records;
+  std::memcpy(&num_records, file->data() + 80, sizeof(uint32_t));
+  if ((size_t)num_records * 3 >= vertexTable::EMPTY) {
+    throw std::runtime_error("STL holds too many triangles to index");
+  }
+  const char* records = file->data() + STL_HEADER_BYTES;
+
+  std::vector<unsigned char> kept(num_records);
+  #pragma omp parallel for
+  for (long long i = 0; i < (long long)num_records; i++) {
+    float corners[9];
+    std::memcpy(corners, records + i * STL_RECORD_BYTES + 3 * sizeof(float), sizeof(corners));
+    std::array<T,9> points;
+    for (int j = 0; j < 9; j++) { points[j] = (T)corners[j]; }
+    kept[i] = isDegenerate(tri<T>(points)) ? 0 : 1;
+  }
+  std::vector<uint32_t> destinations(num_records);
+  std::exclusive_scan(kept.begin(), kept.end(), destinations.begin(), (uint32_t)0);
+  uint32_t num_triangles = (num_records == 0) ? 0 : destinations.back() + kept.back();
+  if (num_degenerate != nullptr) { *num_degenerate = num_records - num_triangles; }
+
+  //* -0.0 is folded onto 0.0 so the two compare equal bitwise
+  size_t num_corners = 3 * (size_t)num_triangles;
+  std::vector<float> positions(3 * num_corners);
+  #pragma omp parallel for
+  for (long long i = 0; i < (long long)num_records; i++) {
+    if (!kept[i]) { continue; }
+    float* corners = positions.data() + 9 * (size_t)destinations[i];
+    std::memcpy(corners, records + i * STL_RECORD_BYTES + 3 * sizeof(float), 9 * sizeof(float));
+    for (int j = 0; j < 9; j++) { corners[j] += 0.0f; }
+  }
+
+  vertexTable table(positions.data(), num_corners);
+  #pragma omp parallel for
+  for (long long c = 0; c < (long long)num_corners; c++) {
+    table.insert((uint32_t)c);
+  }
+  std::vector<uint32_t> firsts(num_corners);
+  std::vector<size_t> vertex_ids(num_corners);
+  #pragma omp parallel for
+  for (long long c = 0; c < (long long)num_corners; c++) {
+    firsts[c] = table.first((uint32_t)c);
+    vertex_ids[c] = (firsts[c] == c) ? 1 : 0;
+  }
+  std::exclusive_scan(vertex_ids.begin(), vertex_ids.end(), vertex_ids.begin(), (size_t)0);
+  size_t num_vertices = (num_corners == 0) ? 0 : vertex_ids.back() + (firsts.back() == num_corners - 1 ? 1 : 0);
+
+  mesh<T> m;
+  m._p.resize(3 * num_vertices);
+  m._c.resize(num_corners);
+  #pragma omp parallel for
+  for (long long c = 0; c < (long long)num_corners; c++) {
+    size_t vertex = vertex_ids[ firsts[c] ];
+    m._c[c] = vertex;
+    if (firsts[c] == c) {
+      for (int k = 0; k < 3; k++) { m._p[3 * vertex + k] = (T)positions[3 * c + k]; }
+    }
+  }
+  return m;
+}
+
+//* num_degenerate, when given, receives the number of degenerate triangles dropped while reading
+template <typename T> mesh<T> getMesh(const std::string& filename, unsigned int* num_degenerate = nullptr) {
+  io::mappedFile file(filename);
+  if (isBinarySTL(&file)) {
+    return readBinarySTL<T>(&file, num_degenerate);
+  }
   std::vector<T> coordinates, normals;
   std::vector<size_t> triangulations, solids;
   stl_reader::ReadStlFile(filename.c_str(), coordinates, normals, triangulations, solids);
   mesh<T> m(coordinates, triangulations);
-  m = removeDegenerateElements(&m);
+  m = removeDegenerateElements(&m, num_degenerate);
   return m;
 }
 
@@ -362,14 +852,19 @@ template <typename T> class BVHNode {
     this->grow(t);
     return *this;
   }
+  BVHNode<T>& grow(v3<T> bbmin, v3<T> bbmax) {
+    _bbmin = vectorElementsMinima(_bbmin, bbmin);
+    _bbmax = vectorElementsMaxima(_bbmax, bbmax);
+    return *this;
+  }
 };
 
-template <typename T> T surfaceArea(BVHNode<T>* b) {
+template <typename T> T surfaceArea(const BVHNode<T>* b) {
   v3<T> span = b->span();
   return ( std::abs(span[0]*span[1]) + std::abs(span[0]*span[2]) + std::abs(span[1]*span[2]) );
 }
 
-template <typename T> T cost(BVHNode<T>* b) {
+template <typename T> T cost(const BVHNode<T>* b) {
   return surfaceArea(b) * b->numTri();
 }
 
@@ -457,15 +952,127 @@ template <typename T> std::pair<T,T> bestSplit(BVHNode<T>* b, mesh<T>* m, unsign
 
 
 
+//* compact BVHNode
+//* float bounds rounded outward so the box never shrinks, whatever the solve precision
+class BVHCompactNode {
+  public:
+  float _bbmin[3];
+  unsigned int _left_or_first;
+  float _bbmax[3];
+  unsigned int _N_tri;
+
+  BVHCompactNode() : _bbmin{INFINITY, INFINITY, INFINITY}, _left_or_first(0), _bbmax{-INFINITY, -INFINITY, -INFINITY}, _N_tri(0) {}
+
+  unsigned int numTri() const { return _N_tri; }
+  bool isLeaf() const { return (_N_tri != 0); }
+  unsigned int childIndex() const { return _left_or_first; }
+  unsigned int firstTriangleIndex() const { return _left_or_first; }
+};
+static_assert(sizeof(BVHCompactNode) == 32, "BVHCompactNode must stay 32 bytes");
+
+//* siblings are always visited together, so they share one cache line
+class alignas(64) BVHCompactPair {
+  public:
+  BVHCompactNode _nodes[2];
+};
+static_assert(sizeof(BVHCompactPair) == 64, "BVHCompactPair must fill one cache line");
+
+template <typename T> float roundDown(T x) {
+  float f = (float)x;
+  if ((T)f > x) { f = std::nextafter(f, -INFINITY); }
+  return f;
+}
+template <typename T> float roundUp(T x) {
+  float f = (float)x;
+  if ((T)f < x) { f = std::nextafter(f, INFINITY); }
+  return f;
+}
+
+template <typename T> BVHCompactNode compactNode(BVHNode<T>* b) {
+  BVHCompactNode c;
+  for (int i = 0; i < 3; i++) {
+    c._bbmin[i] = roundDown(b->min()[i]);
+    c._bbmax[i] = roundUp(b->max()[i]);
+  }
+  c._left_or_first = b->_left_or_first;
+  c._N_tri = b->_N_tri;
+  return c;
+}
+
+
+
+//* precomputed triangle for intersection, vertex A and the edges leaving it
+template <typename T> class BVHTriangle {
+  public:
+  v3<T> _A, _E1, _E2;
+
+  BVHTriangle() {}
+  BVHTriangle(tri<T> t) : _A(t[0]), _E1(t[1] - t[0]), _E2(t[2] - t[0]) {}
+};
+
+//* leaf-ordered triangles split into one array per component so vector kernels load whole lanes, the nine arrays lie
+//* end to end in one block that the BVH owns or that sits in a mapped cache file
+template <typename T> class BVHTriangles {
+  public:
+  const T *_Ax, *_Ay, *_Az;
+  const T *_E1x, *_E1y, *_E1z;
+  const T *_E2x, *_E2y, *_E2z;
+  size_t _size;
+
+  BVHTriangles() :
+    _Ax(nullptr), _Ay(nullptr), _Az(nullptr),
+    _E1x(nullptr), _E1y(nullptr), _E1z(nullptr),
+    _E2x(nullptr), _E2y(nullptr), _E2z(nullptr), _size(0) {}
+  BVHTriangles(const T* block, size_t num_triangles) :
+    _Ax(block), _Ay(block + num_triangles), _Az(block + 2*num_triangles),
+    _E1x(block + 3*num_triangles), _E1y(block + 4*num_triangles), _E1z(block + 5*num_triangles),
+    _E2x(block + 6*num_triangles), _E2y(block + 7*num_triangles), _E2z(block + 8*num_triangles), _size(num_triangles) {}
+
+  size_t size() const { return _size; }
+
+  BVHTriangle<T> operator[](size_t i) const {
+    BVHTriangle<T> t;
+    t._A = v3<T>(_Ax[i], _Ay[i], _Az[i]);
+    t._E1 = v3<T>(_E1x[i], _E1y[i], _E1z[i]);
+    t._E2 = v3<T>(_E2x[i], _E2y[i], _E2z[i]);
+    return t;
+  }
+
+};
+
+//* writes triangle i into each of the nine component arrays of a block holding num_triangles
+template <typename T> void storeTriangle(T* block, size_t num_triangles, size_t i, const BVHTriangle<T>& t) {
+  const T components[9] = { t._A._x, t._A._y, t._A._z, t._E1._x, t._E1._y, t._E1._z, t._E2._x, t._E2._y, t._E2._z };
+  for (int c = 0; c < 9; c++) {
+    block[c * num_triangles + i] = components[c];
+  }
+}
+
+
+
+//* deepest level a node may sit at, the builders stop splitting there so traversal stacks can be fixed size
+const unsigned int BVH_MAX_DEPTH = 64;
+
 //* bvh
 template <typename T>  class BVH {
   public:
   std::vector<BVHNode<T>> _nodes;
   std::vector<unsigned int> _tri_indices;
   unsigned int _nodes_used;
-
-  BVH() {}
-  BVH(mesh<T>* m) {
+  unsigned int _depth;
+  std::vector<BVHCompactPair> _compact;
+  std::vector<T> _triangle_block;
+  //* a finished tree is read through these, they point into the vectors above after a build, or into _file when the
+  //* tree was read from a cache, which then stays mapped for as long as the tree does
+  std::unique_ptr<io::mappedFile> _file;
+  const BVHNode<T>* _node_data;
+  const unsigned int* _index_data;
+  const BVHCompactPair* _pairs;
+  size_t _num_pairs;
+  BVHTriangles<T> _triangles;
+
+  BVH() : _nodes_used(0), _depth(0), _node_data(nullptr), _index_data(nullptr), _pairs(nullptr), _num_pairs(0) {}
+  BVH(mesh<T>* m) : BVH() {
     if (m->size() > 0) {
       std::vector<BVHNode<T>> nodes;
       for (int i = 0; i < 2*m->size() - 1; i++) {
@@ -479,10 +1086,12 @@ template <typename T>  class BVH {
       _tri_indices = tri_indices;
 
       _nodes_used = 0;
+      _depth = 0;
     }
   }
 
   BVHNode<T>* operator[](unsigned int i) { return &(_nodes[i]); }
+  const BVHNode<T>* node(unsigned int i) const { return &(_node_data[i]); }
 
   BVH<T>& swapElements(unsigned int i1, unsigned int i2) {
     unsigned int temp = _tri_indices[i1];
@@ -498,9 +1107,64 @@ template <typename T> void constructNewNode(BVH<T>* bvh, mesh<T>* m, unsigned in
   node->grow(&submesh);
 }
 
+//* repack a finished tree into sibling pairs in depth-first order, root alone in pair 0
+template <typename T> void flattenBVH(BVH<T>* bvh) {
+  std::vector<BVHCompactPair> compact(1);
+  compact.reserve( (bvh->_nodes_used + 1) / 2 + 1 );
+  compact[0]._nodes[0] = compactNode((*bvh)[0]);
+
+  unsigned int depth_reached = 0;
+  std::vector<std::array<unsigned int, 3>> stack = { {0, 0, 0} };
+  while (!stack.empty()) {
+    auto [node_i, compact_i, depth] = stack.back();
+    stack.pop_back();
+    depth_reached = std::max(depth_reached, depth);
+    BVHNode<T>* node = (*bvh)[node_i];
+    if (node->isLeaf()) { continue; }
+
+    unsigned int pair_i = compact.size();
+    unsigned int child_i = node->childIndex();
+    compact.push_back(BVHCompactPair());
+    compact[pair_i]._nodes[0] = compactNode((*bvh)[child_i]);
+    compact[pair_i]._nodes[1] = compactNode((*bvh)[child_i + 1]);
+    compact[compact_i / 2]._nodes[compact_i % 2]._left_or_first = pair_i;
+
+    stack.push_back({child_i + 1, 2*pair_i + 1, depth + 1});
+    stack.push_back({child_i, 2*pair_i, depth + 1});
+  }
+  if (depth_reached > BVH_MAX_DEPTH) {
+    throw std::runtime_error("BVH depth exceeds the traversal limit");
+  }
+  bvh->_compact = compact;
+  bvh->_depth = depth_reached;
+  bvh->_pairs = bvh->_compact.data();
+  bvh->_num_pairs = bvh->_compact.size();
+  bvh->_node_data = bvh->_nodes.data();
+  bvh->_index_data = bvh->_tri_indices.data();
+}
+
+//* copy the triangles in leaf order so leaf tests read contiguous memory
+template <typename T> void gatherTriangles(BVH<T>* bvh, mesh<T>* m) {
+  size_t num_triangles = bvh->_tri_indices.size();
+  bvh->_triangle_block.assign(9 * num_triangles, (T)0.0);
+  T* block = bvh->_triangle_block.data();
+  #pragma omp parallel for
+  for (long long i = 0; i < (long long)num_triangles; i++) {
+    storeTriangle(block, num_triangles, i, BVHTriangle<T>( (*m)[ bvh->_tri_indices[i] ] ));
+  }
+  bvh->_triangles = BVHTriangles<T>(block, num_triangles);
+}
+
+//* child pairs are claimed atomically so subtrees can be built concurrently
+template <typename T> unsigned int allocateChildNodes(BVH<T>* bvh) {
+  unsigned int left_child_index;
+  #pragma omp atomic capture
+  { left_child_index = bvh->_nodes_used; bvh->_nodes_used += 2; }
+  return left_child_index;
+}
+
 template <typename T> unsigned int createChildNodes(BVH<T>* bvh, mesh<T>* m, unsigned int node_i, unsigned int split_index, unsigned int num_left_tri) {
-  unsigned int left_child_index = bvh->_nodes_used;
-  (bvh->_nodes_used) += 2;
+  unsigned int left_child_index = allocateChildNodes(bvh);
   
   BVHNode<T>* node = (*bvh)[node_i];
 
@@ -538,9 +1202,10 @@ template <typename T> unsigned int splitPrimitives(BVH<T>* bvh, mesh<T>* m, unsi
   return split_index;
 }
 
-template <typename T> unsigned int subdivideNode(BVH<T>* bvh, mesh<T>* m, unsigned int node_i) {
+template <typename T> unsigned int subdivideNode(BVH<T>* bvh, mesh<T>* m, unsigned int node_i, unsigned int depth, bool parallel) {
   BVHNode<T>* node = (*bvh)[node_i];
-  if (node->numTri() <= 20) { return 0; }
+  unsigned int num_tri = node->numTri();
+  if (num_tri <= 20 || depth >= BVH_MAX_DEPTH) { return 0; }
 
   unsigned int axis = bestSplitAxis(node);
   std::pair<T,T> split_pos_cost = bestSplit(node, m, axis, 20, &(bvh->_tri_indices));
@@ -552,19 +1217,218 @@ template <typename T> unsigned int subdivideNode(BVH<T>* bvh, mesh<T>* m, unsign
   if (num_left_tri == 0 || num_left_tri == node->numTri()) { return 2; }
 
   unsigned int left_child_index = createChildNodes(bvh, m, node_i, split_index, num_left_tri);
-  subdivideNode(bvh, m, left_child_index);
-  subdivideNode(bvh, m, left_child_index + 1);
+  if (parallel && num_tri > 1024) {
+    #pragma omp task
+    subdivideNode(bvh, m, left_child_index, depth + 1, parallel);
+    #pragma omp task
+    subdivideNode(bvh, m, left_child_index + 1, depth + 1, parallel);
+  } else {
+    subdivideNode(bvh, m, left_child_index, depth + 1, parallel);
+    subdivideNode(bvh, m, left_child_index + 1, depth + 1, parallel);
+  }
 
   return 3;
 }
 
-template <typename T> void constructBVH(BVH<T>* bvh, mesh<T>* m) {
+template <typename T> void constructBVH(BVH<T>* bvh, mesh<T>* m, bool parallel) {
   unsigned int root_i = 0;
   BVHNode<T>* root_node = (*bvh)[root_i];
   root_node->_N_tri = m->size();
   root_node->grow(m);
   bvh->_nodes_used = 1;
-  subdivideNode(bvh, m, root_i);
+  #pragma omp parallel if(parallel)
+  #pragma omp single
+  subdivideNode(bvh, m, root_i, 0, parallel);
+
+  flattenBVH(bvh);
+  gatherTriangles(bvh, m);
+}
+
+
+
+//* binned bvh construction
+template <typename T> class BVHBuildData {
+  public:
+  std::vector<v3<T>> _centroids;
+  std::vector<v3<T>> _bbmins, _bbmaxs;
+
+  BVHBuildData() {}
+  BVHBuildData(mesh<T>* m) : _centroids(m->size()), _bbmins(m->size()), _bbmaxs(m->size()) {
+    #pragma omp parallel for
+    for (int i = 0; i < m->size(); i++) {
+      tri<T> t = (*m)[i];
+      _centroids[i] = centroid(t);
+      _bbmins[i] = vectorElementsMinima(vectorElementsMinima(t[0], t[1]), t[2]);
+      _bbmaxs[i] = vectorElementsMaxima(vectorElementsMaxima(t[0], t[1]), t[2]);
+    }
+  }
+};
+
+template <typename T> class BVHSplit {
+  public:
+  unsigned int _axis, _bin;
+  T _axis_min, _axis_scale, _cost;
+  BVHNode<T> _left, _right;
+
+  BVHSplit() : _axis(0), _bin(0), _axis_min(0.0), _axis_scale(0.0), _cost(INFINITY) {}
+};
+
+template <typename T> unsigned int binIndex(T position, T axis_min, T axis_scale, unsigned int num_bins) {
+  T bin = std::max( (position - axis_min) * axis_scale, (T)0.0 );
+  return std::min( (unsigned int)bin, num_bins - 1 );
+}
+
+template <typename T> BVHSplit<T> binnedSplit(BVHNode<T>* b, BVHBuildData<T>* data, std::vector<unsigned int>* tri_indices, unsigned int num_bins) {
+  unsigned int first = b->firstTriangleIndex();
+  unsigned int last = first + b->numTri();
+
+  BVHNode<T> centroid_bounds;
+  for (unsigned int i = first; i < last; i++) {
+    v3<T> c = data->_centroids[(*tri_indices)[i]];
+    centroid_bounds.grow(c, c);
+  }
+  v3<T> centroid_min = centroid_bounds.min();
+  v3<T> centroid_span = centroid_bounds.span();
+  std::array<T,3> axis_scale;
+  for (int axis = 0; axis < 3; axis++) {
+    axis_scale[axis] = (centroid_span[axis] > 0.0) ? (T)num_bins / centroid_span[axis] : (T)0.0;
+  }
+
+  //* single sweep over the node filling the bins of all three axes
+  std::vector<BVHNode<T>> bins(3 * num_bins);
+  for (unsigned int i = first; i < last; i++) {
+    unsigned int tri_index = (*tri_indices)[i];
+    v3<T> c = data->_centroids[tri_index];
+    for (int axis = 0; axis < 3; axis++) {
+      BVHNode<T>& bin = bins[axis * num_bins + binIndex(c[axis], centroid_min[axis], axis_scale[axis], num_bins)];
+      bin.grow(data->_bbmins[tri_index], data->_bbmaxs[tri_index]);
+      bin._N_tri++;
+    }
+  }
+
+  BVHSplit<T> best;
+  std::vector<BVHNode<T>> left_sweep(num_bins - 1);
+  for (int axis = 0; axis < 3; axis++) {
+    if (axis_scale[axis] == 0.0) { continue; }
+
+    BVHNode<T> left;
+    for (unsigned int i = 0; i < num_bins - 1; i++) {
+      BVHNode<T>* bin = &(bins[axis * num_bins + i]);
+      left.grow(bin->min(), bin->max());
+      left._N_tri += bin->numTri();
+      left_sweep[i] = left;
+    }
+
+    BVHNode<T> right;
+    for (unsigned int i = num_bins - 1; i > 0; i--) {
+      BVHNode<T>* bin = &(bins[axis * num_bins + i]);
+      right.grow(bin->min(), bin->max());
+      right._N_tri += bin->numTri();
+
+      BVHNode<T>* candidate_left = &(left_sweep[i - 1]);
+      if (candidate_left->numTri() == 0 || right.numTri() == 0) { continue; }
+
+      T split_cost = cost(candidate_left) + cost(&right);
+      if (split_cost < best._cost) {
+        best._axis = axis;
+        best._bin = i - 1;
+        best._axis_min = centroid_min[axis];
+        best._axis_scale = axis_scale[axis];
+        best._cost = split_cost;
+        best._left = *candidate_left;
+        best._right = right;
+      }
+    }
+  }
+  return best;
+}
+
+template <typename T> unsigned int partitionPrimitives(BVH<T>* bvh, BVHBuildData<T>* data, unsigned int node_i, BVHSplit<T>* split, unsigned int num_bins) {
+  BVHNode<T>* node = (*bvh)[node_i];
+  auto first = bvh->_tri_indices.begin() + node->firstTriangleIndex();
+  auto last = first + node->numTri();
+  auto split_it = std::partition(first, last, [data, split, num_bins] (unsigned int tri_index) {
+    T position = data->_centroids[tri_index][split->_axis];
+    return ( binIndex(position, split->_axis_min, split->_axis_scale, num_bins) <= split->_bin );
+  });
+  return (unsigned int)std::distance(bvh->_tri_indices.begin(), split_it);
+}
+
+template <typename T> unsigned int createChildNodes(BVH<T>* bvh, unsigned int node_i, unsigned int split_index, BVHSplit<T>* split) {
+  unsigned int left_child_index = allocateChildNodes(bvh);
+
+  BVHNode<T>* node = (*bvh)[node_i];
+
+  BVHNode<T>* left_child = (*bvh)[left_child_index];
+  *left_child = split->_left;
+  left_child->_left_or_first = node->_left_or_first;
+  left_child->_N_tri = split_index - node->_left_or_first;
+
+  BVHNode<T>* right_child = (*bvh)[left_child_index + 1];
+  *right_child = split->_right;
+  right_child->_left_or_first = split_index;
+  right_child->_N_tri = node->numTri() - left_child->numTri();
+
+  node->_left_or_first = left_child_index;
+  node->_N_tri = 0;
+
+  return left_child_index;
+}
+
+template <typename T> unsigned int subdivideNodeBinned(BVH<T>* bvh, BVHBuildData<T>* data, unsigned int node_i, unsigned int depth, bool parallel) {
+  BVHNode<T>* node = (*bvh)[node_i];
+  unsigned int num_tri = node->numTri();
+  if (num_tri <= 20 || depth >= BVH_MAX_DEPTH) { return 0; }
+
+  unsigned int num_bins = 16;
+  BVHSplit<T> split = binnedSplit(node, data, &(bvh->_tri_indices), num_bins);
+  if (cost(node) < split._cost) { return 1; }
+
+  unsigned int split_index = partitionPrimitives(bvh, data, node_i, &split, num_bins);
+
+  unsigned int num_left_tri = split_index - node->firstTriangleIndex();
+  if (num_left_tri == 0 || num_left_tri == node->numTri()) { return 2; }
+
+  unsigned int left_child_index = createChildNodes(bvh, node_i, split_index, &split);
+  if (parallel && num_tri > 1024) {
+    #pragma omp task
+    subdivideNodeBinned(bvh, data, left_child_index, depth + 1, parallel);
+    #pragma omp task
+    subdivideNodeBinned(bvh, data, left_child_index + 1, depth + 1, parallel);
+  } else {
+    subdivideNodeBinned(bvh, data, left_child_index, depth + 1, parallel);
+    subdivideNodeBinned(bvh, data, left_child_index + 1, depth + 1, parallel);
+  }
+
+  return 3;
+}
+
+template <typename T> void constructBVHBinned(BVH<T>* bvh, mesh<T>* m, bool parallel) {
+  BVHBuildData<T> data(m);
+
+  unsigned int root_i = 0;
+  BVHNode<T>* root_node = (*bvh)[root_i];
+  root_node->_N_tri = m->size();
+  for (int i = 0; i < m->size(); i++) {
+    root_node->grow(data._bbmins[i], data._bbmaxs[i]);
+  }
+  bvh->_nodes_used = 1;
+  #pragma omp parallel if(parallel)
+  #pragma omp single
+  subdivideNodeBinned(bvh, &data, root_i, 0, parallel);
+
+  flattenBVH(bvh);
+  gatherTriangles(bvh, m);
+}
+
+//* surface area heuristic cost of a whole tree, relative to its root
+template <typename T> T treeCost(const BVH<T>* bvh) {
+  T total_cost = 0.0;
+  for (unsigned int i = 0; i < bvh->_nodes_used; i++) {
+    const BVHNode<T>* node = bvh->node(i);
+    total_cost += node->isLeaf() ? cost(node) : surfaceArea(node);
+  }
+  return ( total_cost / surfaceArea(bvh->node(0)) );
 }
 
 
@@ -3,6 +3,8 @@
 #include "geometry.hpp"
 #include "solver.hpp"
 #include "results.hpp"
+#include "sparse.hpp"
+#include "mapped_file.hpp"
 
 #pragma once
 
@@ -172,7 +174,7 @@ template <typename T> void writeToFile(geometry::BVH<T>* bvh, const std::string&
   std::vector<unsigned int> leaf_nodes_indices(nodes_used);
   std::iota(leaf_nodes_indices.begin(), leaf_nodes_indices.end(), 0);
   for (int i = 0; i < nodes_used; i++) {
-    if ((*bvh)[i]->isLeaf()) {
+    if (bvh->node(i)->isLeaf()) {
       num_leaf_nodes++;
     } else {
       leaf_nodes_indices[i] = nodes_used;
@@ -188,8 +190,8 @@ template <typename T> void writeToFile(geometry::BVH<T>* bvh, const std::string&
     unsigned int node_index = leaf_nodes_indices[i];
 
     //* adding bounding box vertices to vertices vector
-    geometry::v3<T> bbmin = ((*bvh)[node_index])->min();
-    geometry::v3<T> bbmax = ((*bvh)[node_index])->max();
+    geometry::v3<T> bbmin = bvh->node(node_index)->min();
+    geometry::v3<T> bbmax = bvh->node(node_index)->max();
     geometry::v3<double> p0((double)bbmin[0],(double)bbmin[1],(double)bbmin[2]);
     geometry::v3<double> p1((double)bbmax[0],(double)bbmin[1],(double)bbmin[2]);
     geometry::v3<double> p2((double)bbmax[0],(double)bbmax[1],(double)bbmin[2]);
@@ -248,7 +250,7 @@ template <typename T> void writeToFile(geometry::BVH<T>* bvh, const std::string&
 
 enum VisualOutputMode { EMITTER, RECEIVER, BOTH };
 
-template <typename T> void writeToFile(results::solution<T>* s, geometry::mesh<T>* e, geometry::mesh<T>* r, const std::string& filename, VisualOutputMode mode) {
+template <typename T, typename V> void writeToFile(results::solution<V>* s, geometry::mesh<T>* e, geometry::mesh<T>* r, const std::string& filename, VisualOutputMode mode) {
   int dimension = 3;
   int cell_size = 3;
 
@@ -287,9 +289,7 @@ template <typename T> void writeToFile(results::solution<T>* s, geometry::mesh<T
     if (mode == VisualOutputMode::EMITTER) {
       element_view_factor = (double)( results::emitterElementVF(s, i) );
     } else if (mode == VisualOutputMode::RECEIVER) {
-      std::vector<T> e_areas = geometry::areas(e);
-      T e_area = std::reduce(std::execution::par, e_areas.cbegin(), e_areas.cend());
-      element_view_factor = (double)( results::receiverElementVF(s, i, &e_areas, e_area) );
+      element_view_factor = (double)( results::receiverElementVF(s, i) );
     } else if (mode == VisualOutputMode::BOTH) {
       throw std::runtime_error("No. Just no. I'm not implementing this right now. No need");
     }
@@ -303,5 +303,474 @@ template <typename T> void writeToFile(results::solution<T>* s, geometry::mesh<T
   writer.add_scalar_field(field_name, view_factors);
   writer.write_surface_mesh(filename, dimension, cell_size, points, triangulations);
 }
+
+
+//* binary view factor matrix: a fixed 128 byte header, then the CSR row offsets, column indices and values and
+//* the element areas, each starting on a 64 byte boundary so a mapped file can be used in place
+const char MATRIX_MAGIC[8] = {'O','V','F','M','A','T','R','X'};
+const uint32_t MATRIX_VERSION = 2;
+const uint64_t MATRIX_ALIGNMENT = 64;
+//* header flag of a symmetric single-mesh solve, only the pairs i < j are stored and F_ji = A_i F_ij / A_j
+const uint32_t MATRIX_UPPER_TRIANGULAR = 1;
+
+struct matrixHeader {
+  char _magic[8];
+  uint32_t _version;
+  uint32_t _value_bytes;
+  uint32_t _N_rows;
+  uint32_t _N_cols;
+  uint64_t _nnz;
+  uint64_t _row_offsets_at;
+  uint64_t _col_indices_at;
+  uint64_t _values_at;
+  uint64_t _areas_at;
+  uint32_t _flags;
+  uint32_t _reserved[15];
+};
+static_assert(sizeof(matrixHeader) == 128, "matrix header must stay 128 bytes");
+
+inline uint64_t alignedOffset(uint64_t offset) {
+  return ( (offset + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT ) * MATRIX_ALIGNMENT;
+}
+
+//* writes count values as type S, converting through a small buffer when the source type differs
+template <typename S, typename V> void writeArray(std::ofstream* out, const V* values, size_t count) {
+  if constexpr (std::is_same_v<S, V>) {
+    out->write((const char*)values, count * sizeof(S));
+  } else {
+    const size_t chunk = 1 << 16;
+    std::vector<S> buffer(std::min(count, chunk));
+    for (size_t first = 0; first < count; first += chunk) {
+      size_t n = std::min(chunk, count - first);
+      std::copy(values + first, values + first + n, buffer.begin());
+      out->write((const char*)buffer.data(), n * sizeof(S));
+    }
+  }
+}
+
+inline void padTo(std::ofstream* out, uint64_t offset) {
+  static const char zeros[MATRIX_ALIGNMENT] = {};
+  uint64_t position = (uint64_t)out->tellp();
+  while (position < offset) {
+    uint64_t n = std::min(offset - position, MATRIX_ALIGNMENT);
+    out->write(zeros, n);
+    position += n;
+  }
+}
+
+//* values are stored as float for SINGLE runs and as double otherwise
+template <typename T> using storedValue = std::conditional_t<sizeof(T) == sizeof(float), float, double>;
+
+template <typename S> matrixHeader makeMatrixHeader(unsigned int N_rows, unsigned int N_cols, uint64_t nnz, uint32_t flags) {
+  matrixHeader header = {};
+  std::memcpy(header._magic, MATRIX_MAGIC, sizeof(MATRIX_MAGIC));
+  header._version = MATRIX_VERSION;
+  header._value_bytes = sizeof(S);
+  header._N_rows = N_rows;
+  header._N_cols = N_cols;
+  header._nnz = nnz;
+  header._row_offsets_at = alignedOffset(sizeof(matrixHeader));
+  header._col_indices_at = alignedOffset(header._row_offsets_at + ((uint64_t)N_rows + 1) * sizeof(uint64_t));
+  header._values_at = alignedOffset(header._col_indices_at + nnz * sizeof(uint32_t));
+  header._areas_at = alignedOffset(header._values_at + nnz * sizeof(S));
+  header._flags = flags;
+  return header;
+}
+
+//* the areas section holds the emitter areas then the receiver areas, what rebuilds the lower half of an upper
+//* triangular matrix or the receiver to emitter factors of any other
+template <typename S, typename V> void writeAreas(std::ofstream* out, const std::vector<V>* emitter_areas, const std::vector<V>* receiver_areas, const matrixHeader& header) {
+  if (emitter_areas->size() != header._N_rows || receiver_areas->size() != header._N_cols) {
+    throw std::runtime_error("Element areas do not match the matrix dimensions");
+  }
+  padTo(out, header._areas_at);
+  writeArray<S>(out, emitter_areas->data(), emitter_areas->size());
+  writeArray<S>(out, receiver_areas->data(), receiver_areas->size());
+}
+
+template <typename T, typename V> void writeToFile(const sparse::csr<T>* m, const std::vector<V>* emitter_areas, const std::vector<V>* receiver_areas, const std::string& filename, uint32_t flags = 0) {
+  using S = storedValue<T>;
+  matrixHeader header = makeMatrixHeader<S>(m->_N_rows, m->_N_cols, m->nnz(), flags);
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open " + filename + " for writing");
+  }
+  out.write((const char*)&header, sizeof(matrixHeader));
+  padTo(&out, header._row_offsets_at);
+  writeArray<uint64_t>(&out, m->_row_offsets.data(), m->_row_offsets.size());
+  padTo(&out, header._col_indices_at);
+  writeArray<uint32_t>(&out, m->_col_indices.data(), m->_col_indices.size());
+  padTo(&out, header._values_at);
+  writeArray<S>(&out, m->_values.data(), m->_values.size());
+  writeAreas<S>(&out, emitter_areas, receiver_areas, header);
+  if (!out) {
+    throw std::runtime_error("Failed writing " + filename);
+  }
+}
+
+//* writes the same file one block of rows at a time, so the whole matrix is never held at once,
+//* column indices go straight into the file and values into a scratch file appended on close
+template <typename T> class matrixWriter {
+  private:
+  using S = storedValue<T>;
+  std::string _filename;
+  std::string _values_filename;
+  std::ofstream _out;
+  std::ofstream _values_out;
+  matrixHeader _header;
+  unsigned int _rows_written;
+
+  public:
+  matrixWriter() : _header(), _rows_written(0) {}
+
+  void open(const std::string& filename, unsigned int N_rows, unsigned int N_cols, uint32_t flags = 0) {
+    _filename = filename;
+    _values_filename = filename + ".values";
+    _header = makeMatrixHeader<S>(N_rows, N_cols, 0, flags);
+    _rows_written = 0;
+
+    _out.open(_filename, std::ios::binary | std::ios::trunc);
+    _values_out.open(_values_filename, std::ios::binary | std::ios::trunc);
+    if (!_out || !_values_out) {
+      throw std::runtime_error("Could not open " + filename + " for writing");
+    }
+    _out.write((const char*)&_header, sizeof(matrixHeader));
+    padTo(&_out, _header._row_offsets_at);
+    uint64_t first_offset = 0;
+    _out.write((const char*)&first_offset, sizeof(uint64_t));
+    padTo(&_out, _header._col_indices_at);
+  }
+
+  void append(const sparse::csr<T>* rows) {
+    if (_rows_written + rows->_N_rows > _header._N_rows || rows->_N_cols != _header._N_cols) {
+      throw std::runtime_error("Rows appended to " + _filename + " do not fit the matrix");
+    }
+    std::vector<uint64_t> row_offsets(rows->_N_rows);
+    for (unsigned int row = 0; row < rows->_N_rows; row++) {
+      row_offsets[row] = _header._nnz + rows->_row_offsets[row + 1];
+    }
+    std::streampos end = _out.tellp();
+    _out.seekp(_header._row_offsets_at + ((uint64_t)_rows_written + 1) * sizeof(uint64_t));
+    writeArray<uint64_t>(&_out, row_offsets.data(), row_offsets.size());
+    _out.seekp(end);
+
+    writeArray<uint32_t>(&_out, rows->_col_indices.data(), rows->_col_indices.size());
+    writeArray<S>(&_values_out, rows->_values.data(), rows->_values.size());
+    _rows_written += rows->_N_rows;
+    _header._nnz += rows->nnz();
+  }
+
+  template <typename V> void close(const std::vector<V>* emitter_areas, const std::vector<V>* receiver_areas) {
+    if (_rows_written != _header._N_rows) {
+      throw std::runtime_error(_filename + " was closed after " + std::to_string(_rows_written) + " of " + std::to_string(_header._N_rows) + " rows");
+    }
+    _values_out.close();
+    _header._values_at = alignedOffset(_header._col_indices_at + _header._nnz * sizeof(uint32_t));
+    padTo(&_out, _header._values_at);
+    if (_header._nnz > 0) {
+      std::ifstream values_in(_values_filename, std::ios::binary);
+      _out << values_in.rdbuf();
+    }
+    _header._areas_at = alignedOffset(_header._values_at + _header._nnz * sizeof(S));
+    writeAreas<S>(&_out, emitter_areas, receiver_areas, _header);
+    _out.seekp(0);
+    _out.write((const char*)&_header, sizeof(matrixHeader));
+    _out.close();
+    std::remove(_values_filename.c_str());
+    if (_out.fail()) {
+      throw std::runtime_error("Failed writing " + _filename);
+    }
+  }
+};
+
+//* maps a binary matrix file and hands out pointers straight into it, nothing is parsed or copied
+class mappedMatrix {
+  private:
+  mappedFile _file;
+  const matrixHeader* _header;
+
+  public:
+  mappedMatrix(const std::string& filename) : _file(filename), _header(nullptr) {
+    if (_file.size() < sizeof(matrixHeader)) {
+      throw std::runtime_error(filename + " is too small to be a view factor matrix");
+    }
+    _header = (const matrixHeader*)_file.data();
+    if (std::memcmp(_header->_magic, MATRIX_MAGIC, sizeof(MATRIX_MAGIC)) != 0) {
+      throw std::runtime_error(filename + " is not a view factor matrix");
+    }
+    if (_header->_version != MATRIX_VERSION) {
+      throw std::runtime_error(filename + " has unsupported matrix version " + std::to_string(_header->_version));
+    }
+    if (_file.size() < _header->_areas_at + ((uint64_t)_header->_N_rows + _header->_N_cols) * _header->_value_bytes) {
+      throw std::runtime_error(filename + " is truncated");
+    }
+  }
+
+  const matrixHeader* header() const { return _header; }
+  unsigned int rows() const { return _header->_N_rows; }
+  unsigned int cols() const { return _header->_N_cols; }
+  uint64_t nnz() const { return _header->_nnz; }
+  bool upperTriangular() const { return (_header->_flags & MATRIX_UPPER_TRIANGULAR) != 0; }
+
+  const uint64_t* rowOffsets() const { return (const uint64_t*)(_file.data() + _header->_row_offsets_at); }
+  const uint32_t* colIndices() const { return (const uint32_t*)(_file.data() + _header->_col_indices_at); }
+  template <typename V> const V* values() const {
+    if (sizeof(V) != _header->_value_bytes) {
+      throw std::runtime_error("Matrix values are stored with " + std::to_string(_header->_value_bytes) + " bytes each");
+    }
+    return (const V*)(_file.data() + _header->_values_at);
+  }
+  //* the rows() emitter areas followed by the cols() receiver areas, stored in the value type
+  template <typename V> const V* areas() const {
+    if (sizeof(V) != _header->_value_bytes) {
+      throw std::runtime_error("Matrix areas are stored with " + std::to_string(_header->_value_bytes) + " bytes each");
+    }
+    return (const V*)(_file.data() + _header->_areas_at);
+  }
+};
+
+
+//* visibility cache file: a 64 byte header naming the geometry hash it was filled for, then the cache words
+const char VISIBILITY_MAGIC[8] = {'O','V','F','V','I','S','I','B'};
+const uint32_t VISIBILITY_VERSION = 1;
+
+struct visibilityHeader {
+  char _magic[8];
+  uint32_t _version;
+  uint32_t _unordered;
+  uint64_t _hash;
+  uint32_t _N_e;
+  uint32_t _N_r;
+  uint64_t _num_words;
+  uint64_t _reserved[3];
+};
+static_assert(sizeof(visibilityHeader) == 64, "visibility header must stay 64 bytes");
+
+inline void writeToFile(const solver::visibilityCache* cache, const std::string& filename) {
+  visibilityHeader header = {};
+  std::memcpy(header._magic, VISIBILITY_MAGIC, sizeof(VISIBILITY_MAGIC));
+  header._version = VISIBILITY_VERSION;
+  header._unordered = cache->_unordered ? 1 : 0;
+  header._hash = cache->_hash;
+  header._N_e = cache->_N_e;
+  header._N_r = cache->_N_r;
+  header._num_words = cache->_words.size();
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open " + filename + " for writing");
+  }
+  out.write((const char*)&header, sizeof(visibilityHeader));
+  const size_t chunk = 1 << 16;
+  std::vector<uint64_t> buffer(std::min(cache->_words.size(), chunk));
+  for (size_t first = 0; first < cache->_words.size(); first += chunk) {
+    size_t n = std::min(chunk, cache->_words.size() - first);
+    for (size_t i = 0; i < n; i++) {
+      buffer[i] = cache->_words[first + i].load(std::memory_order_relaxed);
+    }
+    out.write((const char*)buffer.data(), n * sizeof(uint64_t));
+  }
+  if (!out) {
+    throw std::runtime_error("Failed writing " + filename);
+  }
+}
+
+//* fills the cache from a file written for the same geometry, returns false and leaves it untouched otherwise
+inline bool readVisibilityCache(const std::string& filename, solver::visibilityCache* cache) {
+  if (!std::ifstream(filename).good()) {
+    return false;
+  }
+  mappedFile file(filename);
+  if (file.size() < sizeof(visibilityHeader)) {
+    return false;
+  }
+  const visibilityHeader* header = (const visibilityHeader*)file.data();
+  if (std::memcmp(header->_magic, VISIBILITY_MAGIC, sizeof(VISIBILITY_MAGIC)) != 0 || header->_version != VISIBILITY_VERSION) {
+    return false;
+  }
+  if (header->_hash != cache->_hash || header->_unordered != (cache->_unordered ? 1u : 0u)
+      || header->_N_e != cache->_N_e || header->_N_r != cache->_N_r || header->_num_words != cache->_words.size()) {
+    return false;
+  }
+  if (file.size() < sizeof(visibilityHeader) + header->_num_words * sizeof(uint64_t)) {
+    return false;
+  }
+  const uint64_t* words = (const uint64_t*)(file.data() + sizeof(visibilityHeader));
+  #pragma omp parallel for
+  for (long long i = 0; i < (long long)header->_num_words; i++) {
+    cache->_words[i].store(words[i], std::memory_order_relaxed);
+  }
+  return true;
+}
+
+
+//* bvh cache file: a 64 byte header naming the blocker hash it was built for and a checksum of the rest, then the
+//* sibling pairs, the build nodes, the leaf-ordered triangle indices and, from the next 64 byte boundary, the block
+//* of leaf-ordered triangles, laid out as the tree holds them so a mapped file is traversed in place
+const char BVH_MAGIC[8] = {'O','V','F','B','V','H','\0','\0'};
+const uint32_t BVH_VERSION = 3;
+
+struct bvhHeader {
+  char _magic[8];
+  uint32_t _version;
+  uint32_t _value_bytes;
+  uint64_t _hash;
+  uint32_t _nodes_used;
+  uint32_t _depth;
+  uint64_t _num_pairs;
+  uint64_t _num_tri;
+  uint64_t _checksum;
+  uint64_t _reserved;
+};
+static_assert(sizeof(bvhHeader) == 64, "bvh header must stay 64 bytes");
+
+//* bytes of the pairs, nodes and indices, after which the triangle block starts on a cache line
+inline uint64_t bvhTrianglesAt(uint64_t tree_bytes) {
+  return ( (sizeof(bvhHeader) + tree_bytes + 63) / 64 ) * 64;
+}
+
+//* written beside the target and renamed over it, so a run sharing the cache never maps a half written tree
+template <typename T> void writeBVHCache(const geometry::BVH<T>* bvh, uint64_t hash, const std::string& filename) {
+  bvhHeader header = {};
+  std::memcpy(header._magic, BVH_MAGIC, sizeof(BVH_MAGIC));
+  header._version = BVH_VERSION;
+  header._value_bytes = sizeof(T);
+  header._hash = hash;
+  header._nodes_used = bvh->_nodes_used;
+  header._depth = bvh->_depth;
+  header._num_pairs = bvh->_num_pairs;
+  header._num_tri = bvh->_triangles.size();
+  size_t pairs_bytes = bvh->_num_pairs * sizeof(geometry::BVHCompactPair);
+  size_t nodes_bytes = (size_t)bvh->_nodes_used * sizeof(geometry::BVHNode<T>);
+  size_t indices_bytes = header._num_tri * sizeof(unsigned int);
+  size_t triangles_bytes = 9 * header._num_tri * sizeof(T);
+  header._checksum = solver::contentHash(bvh->_pairs, pairs_bytes);
+  header._checksum = solver::contentHash(bvh->_node_data, nodes_bytes, header._checksum);
+  header._checksum = solver::contentHash(bvh->_index_data, indices_bytes, header._checksum);
+  header._checksum = solver::contentHash(bvh->_triangles._Ax, triangles_bytes, header._checksum);
+
+  std::string partial_filename = filename + ".partial";
+  {
+    std::ofstream out(partial_filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Could not open " + partial_filename + " for writing");
+    }
+    out.write((const char*)&header, sizeof(bvhHeader));
+    out.write((const char*)bvh->_pairs, pairs_bytes);
+    out.write((const char*)bvh->_node_data, nodes_bytes);
+    out.write((const char*)bvh->_index_data, indices_bytes);
+    padTo(&out, bvhTrianglesAt(pairs_bytes + nodes_bytes + indices_bytes));
+    out.write((const char*)bvh->_triangles._Ax, triangles_bytes);
+    if (!out) {
+      throw std::runtime_error("Failed writing " + partial_filename);
+    }
+  }
+#ifdef _WIN32
+  std::remove(filename.c_str());
+#endif
+  if (std::rename(partial_filename.c_str(), filename.c_str()) != 0) {
+    std::remove(partial_filename.c_str());
+    throw std::runtime_error("Could not replace " + filename);
+  }
+}
+
+//* walks the sibling pairs from the root like traversal does, every child has to name a later pair and every leaf a
+//* range of the triangle indices, and no path may run deeper than the fixed traversal stacks
+inline bool validBVHPairs(const geometry::BVHCompactPair* pairs, uint64_t num_pairs, uint64_t num_tri) {
+  if (num_pairs == 0) {
+    return false;
+  }
+  std::vector<std::array<uint64_t, 3>> stack = { {0, 0, 0} };
+  uint64_t num_visited = 0;
+  while (!stack.empty()) {
+    auto [pair_i, slot, depth] = stack.back();
+    stack.pop_back();
+    if (depth > geometry::BVH_MAX_DEPTH || ++num_visited > 2 * num_pairs) {
+      return false;
+    }
+    const geometry::BVHCompactNode* node = &(pairs[pair_i]._nodes[slot]);
+    if (node->isLeaf()) {
+      if (node->firstTriangleIndex() > num_tri || node->numTri() > num_tri - node->firstTriangleIndex()) {
+        return false;
+      }
+      continue;
+    }
+    uint64_t child_i = node->childIndex();
+    if (child_i <= pair_i || child_i >= num_pairs) {
+      return false;
+    }
+    stack.push_back({child_i, 0, depth + 1});
+    stack.push_back({child_i, 1, depth + 1});
+  }
+  return true;
+}
+
+//* maps a tree built for the same blockers and keeps the mapping in the tree, traversal then reads the pairs and
+//* triangles straight from the file. Returns false and leaves the tree untouched when the file was written for other
+//* blockers, is damaged or holds indices traversal cannot follow
+template <typename T> bool readBVHCache(const std::string& filename, uint64_t hash, geometry::BVH<T>* bvh, geometry::mesh<T>* m) {
+  if (!std::ifstream(filename).good()) {
+    return false;
+  }
+  auto file = std::make_unique<mappedFile>(filename);
+  if (file->size() < sizeof(bvhHeader)) {
+    return false;
+  }
+  const bvhHeader* header = (const bvhHeader*)file->data();
+  if (std::memcmp(header->_magic, BVH_MAGIC, sizeof(BVH_MAGIC)) != 0 || header->_version != BVH_VERSION) {
+    return false;
+  }
+  if (header->_hash != hash || header->_value_bytes != sizeof(T) || header->_num_tri != m->size()) {
+    return false;
+  }
+  if (header->_depth > geometry::BVH_MAX_DEPTH || header->_nodes_used == 0) {
+    return false;
+  }
+  size_t body_size = file->size() - sizeof(bvhHeader);
+  if (header->_num_pairs > body_size / sizeof(geometry::BVHCompactPair)) {
+    return false;
+  }
+  size_t pairs_bytes = header->_num_pairs * sizeof(geometry::BVHCompactPair);
+  size_t nodes_bytes = (size_t)header->_nodes_used * sizeof(geometry::BVHNode<T>);
+  size_t indices_bytes = header->_num_tri * sizeof(unsigned int);
+  if (body_size - pairs_bytes < nodes_bytes || body_size - pairs_bytes - nodes_bytes < indices_bytes) {
+    return false;
+  }
+  uint64_t triangles_at = bvhTrianglesAt(pairs_bytes + nodes_bytes + indices_bytes);
+  size_t triangles_bytes = 9 * header->_num_tri * sizeof(T);
+  if (file->size() < triangles_at || file->size() - triangles_at < triangles_bytes) {
+    return false;
+  }
+
+  const char* section = file->data() + sizeof(bvhHeader);
+  const char* triangles = file->data() + triangles_at;
+  uint64_t checksum = solver::contentHash(section, pairs_bytes + nodes_bytes + indices_bytes);
+  if (solver::contentHash(triangles, triangles_bytes, checksum) != header->_checksum) {
+    return false;
+  }
+  const geometry::BVHCompactPair* pairs = (const geometry::BVHCompactPair*)section;
+  const unsigned int* tri_indices = (const unsigned int*)(section + pairs_bytes + nodes_bytes);
+  if (!validBVHPairs(pairs, header->_num_pairs, header->_num_tri)) {
+    return false;
+  }
+  if (!std::all_of(tri_indices, tri_indices + header->_num_tri, [m] (unsigned int i) { return (i < m->size()); })) {
+    return false;
+  }
+
+  bvh->_nodes = std::vector<geometry::BVHNode<T>>();
+  bvh->_tri_indices = std::vector<unsigned int>();
+  bvh->_compact = std::vector<geometry::BVHCompactPair>();
+  bvh->_triangle_block = std::vector<T>();
+  bvh->_pairs = pairs;
+  bvh->_num_pairs = header->_num_pairs;
+  bvh->_node_data = (const geometry::BVHNode<T>*)(section + pairs_bytes);
+  bvh->_index_data = tri_indices;
+  bvh->_triangles = geometry::BVHTriangles<T>((const T*)triangles, header->_num_tri);
+  bvh->_nodes_used = header->_nodes_used;
+  bvh->_depth = header->_depth;
+  bvh->_file = std::move(file);
+  return true;
+}
   
 }
\ No newline at end of file
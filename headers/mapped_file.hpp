@@ -0,0 +1,90 @@
+#include "all_headers.hpp"
+
+#pragma once
+
+//! ----- MEMORY MAPPED FILES ----- !//
+
+namespace io {
+
+//* read-only view of a whole file, the OS pages it in on demand instead of it being read and parsed up front
+class mappedFile {
+  private:
+  const char* _data;
+  size_t _size;
+#ifdef _WIN32
+  HANDLE _file;
+  HANDLE _mapping;
+#else
+  int _file;
+#endif
+
+  void release() {
+#ifdef _WIN32
+    if (_data != nullptr) { UnmapViewOfFile(_data); }
+    if (_mapping != NULL) { CloseHandle(_mapping); }
+    if (_file != INVALID_HANDLE_VALUE) { CloseHandle(_file); }
+    _mapping = NULL;
+    _file = INVALID_HANDLE_VALUE;
+#else
+    if (_data != nullptr) { munmap((void*)_data, _size); }
+    if (_file != -1) { close(_file); }
+    _file = -1;
+#endif
+    _data = nullptr;
+    _size = 0;
+  }
+
+  public:
+#ifdef _WIN32
+  mappedFile() : _data(nullptr), _size(0), _file(INVALID_HANDLE_VALUE), _mapping(NULL) {}
+#else
+  mappedFile() : _data(nullptr), _size(0), _file(-1) {}
+#endif
+  mappedFile(const std::string& filename) : mappedFile() { open(filename); }
+  ~mappedFile() { release(); }
+
+  mappedFile(const mappedFile&) = delete;
+  mappedFile& operator=(const mappedFile&) = delete;
+
+  void open(const std::string& filename) {
+    release();
+#ifdef _WIN32
+    _file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (_file == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("Could not open " + filename);
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(_file, &file_size);
+    _size = (size_t)file_size.QuadPart;
+    if (_size == 0) { return; }
+    _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (_mapping == NULL) {
+      release();
+      throw std::runtime_error("Could not map " + filename);
+    }
+    _data = (const char*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    _file = ::open(filename.c_str(), O_RDONLY);
+    if (_file == -1) {
+      throw std::runtime_error("Could not open " + filename);
+    }
+    struct stat file_stat;
+    fstat(_file, &file_stat);
+    _size = (size_t)file_stat.st_size;
+    if (_size == 0) { return; }
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+    if (data == MAP_FAILED) { data = nullptr; }
+    _data = (const char*)data;
+#endif
+    if (_data == nullptr) {
+      release();
+      throw std::runtime_error("Could not map " + filename);
+    }
+  }
+
+  const char* data() const { return _data; }
+  size_t size() const { return _size; }
+  bool isOpen() const { return (_data != nullptr); }
+};
+
+}
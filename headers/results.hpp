@@ -2,6 +2,7 @@
 
 #include "geometry.hpp"
 #include "solver.hpp"
+#include "sparse.hpp"
 
 #pragma once
 
@@ -9,91 +10,158 @@
 
 namespace results {
 
+  //* adds the rows of an upper triangular block starting at global row first_row onto the totals of the full
+  //* matrix, each stored F_ij also stands for F_ji = A_i F_ij / A_j by reciprocity. rows are visited in order so
+  //* streamed blocks sum exactly like the whole matrix
+  template <typename T> void addReciprocalTotals(const sparse::csr<T>* upper, unsigned int first_row, const std::vector<T>* areas, std::vector<T>* emitter_totals, std::vector<T>* receiver_totals) {
+    for (unsigned int row = 0; row < upper->_N_rows; row++) {
+      unsigned int i = first_row + row;
+      const unsigned int* columns = upper->rowColumns(row);
+      const T* values = upper->rowValues(row);
+      for (size_t k = 0; k < upper->rowSize(row); k++) {
+        unsigned int j = columns[k];
+        T reciprocal = (*areas)[i] * values[k] / (*areas)[j];
+        (*emitter_totals)[i] += values[k];
+        (*emitter_totals)[j] += reciprocal;
+        (*receiver_totals)[j] += values[k];
+        (*receiver_totals)[i] += reciprocal;
+      }
+    }
+  }
+
   template <typename T> class solution {
     public:
-    std::vector<std::vector<unsigned int>*>* _e_indices;
-    std::vector<std::vector<T>*>* _vf;
+    sparse::csr<T> _matrix;
+    std::vector<T> _emitter_totals;
+    std::vector<T> _receiver_totals;
+    std::vector<T> _areas;
     unsigned int _N_e;
     unsigned int _N_r;
-  
-    //TODO rewrite constructors for new vector formats
-    solution() {
-      std::vector<std::vector<unsigned int>*> indices;
-      _e_indices = &indices;
-      std::vector<std::vector<T>*> results;
-      _vf = &results;
-      _N_e = 0;
-      _N_r = 0;
+    bool _symmetric;
+
+    solution() : _N_e(0), _N_r(0), _symmetric(false) {}
+    //* emitter totals are row sums over the stored nonzeros, receiver totals add each stored value onto its column
+    solution(sparse::csr<T>&& matrix) : _matrix(std::move(matrix)), _symmetric(false) {
+      _N_e = _matrix._N_rows;
+      _N_r = _matrix._N_cols;
+      _emitter_totals = _matrix.rowSums();
+      _receiver_totals.assign(_N_r, (T)0.0);
+      _matrix.addColumnSums(&_receiver_totals);
     }
-    solution(std::vector<std::vector<unsigned int>*>* e_indices, std::vector<std::vector<T>*>* vf, unsigned int N_e, unsigned int N_r) {
-      _e_indices = e_indices;
-      _vf = vf;
-      _N_e = N_e;
-      _N_r = N_r;
+    //* a single mesh solved over its pairs i < j only, the rest of the matrix follows from the element areas
+    solution(sparse::csr<T>&& upper, const std::vector<T>& areas) : _matrix(std::move(upper)), _areas(areas), _symmetric(true) {
+      _N_e = _matrix._N_rows;
+      _N_r = _matrix._N_cols;
+      reciprocalTotals();
+    }
+    //* totals only, for solves that streamed their matrix to disk tile by tile
+    solution(unsigned int N_e, unsigned int N_r, std::vector<T>&& emitter_totals, std::vector<T>&& receiver_totals)
+      : _emitter_totals(std::move(emitter_totals)), _receiver_totals(std::move(receiver_totals)), _N_e(N_e), _N_r(N_r), _symmetric(false) {}
+
+    //* both totals of a symmetric solve come out of the one pass over the upper triangle
+    void reciprocalTotals() {
+      _emitter_totals.assign(_N_e, (T)0.0);
+      _receiver_totals.assign(_N_r, (T)0.0);
+      addReciprocalTotals(&_matrix, 0, &_areas, &_emitter_totals, &_receiver_totals);
     }
+
+    //* per-element totals, filled when the solution is built so parallel readers never write them
+    const std::vector<T>& emitterTotals() const { return _emitter_totals; }
+    const std::vector<T>& receiverTotals() const { return _receiver_totals; }
   
-    T operator[](unsigned int i) {
+    //* entries below the diagonal of a symmetric solve are read from their mirror and scaled by the areas
+    T operator[](size_t i) const {
       unsigned int e_index = i / _N_r;
       unsigned int r_index = i % _N_r;
-      std::vector<unsigned int>* e_indices = (*_e_indices)[e_index];
-      int index_in_e_indices = binarySearch(e_indices, r_index, 0, e_indices->size());
-      if (index_in_e_indices != -1) {
-        std::vector<T>* sub_results = (*_vf)[e_index];
-        T result = (*sub_results)[index_in_e_indices];
-        return ( result );
+      if (_symmetric && e_index >= r_index) {
+        if (e_index == r_index) {
+          return ( (T)0.0 );
+        }
+        return ( _areas[r_index] * entry(r_index, e_index) / _areas[e_index] );
       }
-      return ( (T)0.0 );
+      return entry(e_index, r_index);
     }
 
-    int binarySearch(std::vector<unsigned int>* v, unsigned int i, unsigned int inclusive_start, unsigned int uninclusive_end) {
-      if (uninclusive_end > inclusive_start) {
-        int midpoint = (int)((inclusive_start + uninclusive_end) / 2);
-        if ( (*v)[midpoint] == i ) { return midpoint; }
-        if ( (*v)[midpoint] > i ) { return binarySearch(v, i, inclusive_start, midpoint); }
-        return binarySearch(v, i, midpoint + 1, uninclusive_end);
+    T entry(unsigned int e_index, unsigned int r_index) const {
+      const unsigned int* first = _matrix.rowColumns(e_index);
+      const unsigned int* last = first + _matrix.rowSize(e_index);
+      const unsigned int* found = std::lower_bound(first, last, r_index);
+      if (found != last && *found == r_index) {
+        return _matrix.rowValues(e_index)[found - first];
       }
-      return -1;
+      return ( (T)0.0 );
     }
   };
   
   
-  template <typename T> T vfElement(solution<T>* s, unsigned int i) {
+  template <typename T> T vfElement(solution<T>* s, size_t i) {
     return ( (*s)[i] );
   }
   
   template <typename T> T vfElement(solution<T>* s, unsigned int e, unsigned int r) {
-    unsigned int i = e * s->_N_r + r;
+    size_t i = (size_t)e * s->_N_r + r;
     return ( (*s)[i] );
   }
   
-  template <typename T> T emitterElementVF(solution<T>* s, unsigned int e) {
-    T total_vf = 0.0;
-    for (int i = 0; i < s->_N_r; i++) {
-      total_vf += vfElement(s, e, i);
-    }
-    return total_vf;
-    // std::vector<T>* e_vfs = ( (*s)._vf )[e];
-    // T total_vf = std::reduce(e_vfs->cbegin(), e_vfs->cend());
-    // return total_vf;
+  template <typename T> T emitterElementVF(const solution<T>* s, unsigned int e) {
+    return s->emitterTotals()[e];
   }
 
-  template <typename T> T receiverElementVF(solution<T>* s, unsigned int r, std::vector<T>* e_areas, T e_area) {
-    T total_vf = 0.0;
-    for (int i = 0; i < s->_N_e; i++) {
-      total_vf += vfElement(s, i, r);
-    }
-    return total_vf;
+  template <typename T> T receiverElementVF(const solution<T>* s, unsigned int r) {
+    return s->receiverTotals()[r];
   }
   
-  template <typename T> T surfaceVF(solution<T>* s, std::vector<T>* e_areas) {
+  //* Neumaier running sum, the rounding error of every addition is kept and added back at the end
+  template <typename T> class compensatedSum {
+    public:
+    T _sum;
+    T _compensation;
+
+    compensatedSum() : _sum(0.0), _compensation(0.0) {}
+
+    void add(T value) {
+      T total = _sum + value;
+      if (std::abs(_sum) >= std::abs(value)) {
+        _compensation += (_sum - total) + value;
+      } else {
+        _compensation += (value - total) + _sum;
+      }
+      _sum = total;
+    }
+
+    T value() const { return ( _sum + _compensation ); }
+  };
+
+  const size_t SUM_CHUNK = 4096;
+
+  //* chunks are summed in parallel and their partial sums combined in chunk order, so the result does not
+  //* depend on the thread count
+  template <typename T> T sum(const std::vector<T>* values) {
+    size_t num_chunks = (values->size() + SUM_CHUNK - 1) / SUM_CHUNK;
+    std::vector<compensatedSum<T>> partials(num_chunks);
+    #pragma omp parallel for
+    for (int chunk = 0; chunk < num_chunks; chunk++) {
+      size_t last = std::min((chunk + 1) * SUM_CHUNK, values->size());
+      for (size_t i = chunk * SUM_CHUNK; i < last; i++) {
+        partials[chunk].add((*values)[i]);
+      }
+    }
+    compensatedSum<T> total;
+    for (auto& partial : partials) {
+      total.add(partial._sum);
+      total.add(partial._compensation);
+    }
+    return total.value();
+  }
+
+  template <typename T> T surfaceVF(solution<T>* s, const std::vector<T>* e_areas) {
+    const std::vector<T>& emitter_totals = s->emitterTotals();
     std::vector<T> element_vf(s->_N_e);
     #pragma omp parallel for
     for (int i = 0; i < s->_N_e; i++) {
-      element_vf[i] = emitterElementVF(s, i) * (*e_areas)[i];
+      element_vf[i] = emitter_totals[i] * (*e_areas)[i];
     }
-    T sum = std::reduce(std::execution::par, element_vf.cbegin(), element_vf.cend(), (T)0.0);
-    T e_area = std::reduce(std::execution::par, (*e_areas).cbegin(), (*e_areas).cend(), (T)0.0);
-    T total_vf = sum / e_area;
+    T total_vf = sum(&element_vf) / sum(e_areas);
     return total_vf;
   }
   
@@ -0,0 +1,683 @@
+#include "all_headers.hpp"
+
+#include "geometry.hpp"
+
+#pragma once
+
+//! ----- SIMD KERNELS ----- !//
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OVF_X86_SIMD
+#endif
+
+//* gcc contracts vector mul/add pairs into fused multiply-adds unless told not to,
+//* which would round differently from the scalar test
+#if defined(OVF_X86_SIMD) && defined(__clang__)
+#define OVF_TARGET(isa) __attribute__((target(isa)))
+#elif defined(OVF_X86_SIMD) && defined(__GNUC__)
+#define OVF_TARGET(isa) __attribute__((target(isa), optimize("fp-contract=off")))
+#else
+#define OVF_TARGET(isa)
+#endif
+
+namespace simd {
+
+enum Level { SCALAR, AVX2, AVX512 };
+
+static std::map<Level, std::string> LEVEL_TO_OUTPUT = {
+  {Level::SCALAR, "SCALAR"},
+  {Level::AVX2, "AVX2"},
+  {Level::AVX512, "AVX512"} };
+
+inline Level detectLevel() {
+#if defined(OVF_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) { return Level::AVX512; }
+  if (__builtin_cpu_supports("avx2")) { return Level::AVX2; }
+#elif defined(OVF_X86_SIMD) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] >= 7) {
+    __cpuidex(info, 1, 0);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+    bool os_saves_zmm = os_saves_ymm && ((_xgetbv(0) & 0xE6) == 0xE6);
+    __cpuidex(info, 7, 0);
+    if (os_saves_zmm && (info[1] & (1 << 16))) { return Level::AVX512; }
+    if (os_saves_ymm && (info[1] & (1 << 5))) { return Level::AVX2; }
+  }
+#endif
+  return Level::SCALAR;
+}
+
+//* the scalar test compares against the double literals -0.001 and 1.001,
+//* these are the nearest T bounds that make every comparison come out the same
+template <typename T> T lowerTolerance() {
+  T bound = (T)(-0.001);
+  if ((double)bound < -0.001) { bound = std::nextafter(bound, (T)INFINITY); }
+  return bound;
+}
+template <typename T> T upperTolerance() {
+  T bound = (T)(1.001);
+  if ((double)bound > 1.001) { bound = std::nextafter(bound, (T)-INFINITY); }
+  return bound;
+}
+
+#ifdef OVF_X86_SIMD
+
+//* Each kernel tests one ray against a run of leaf triangles and returns the nearest
+//* positive hit distance (INFINITY for none). Operations follow the scalar
+//* Moller-Trumbore test one-for-one, so every lane is bitwise identical to the scalar result.
+
+OVF_TARGET("avx2") inline float leafMinimumAVX2(const geometry::BVHTriangles<float>* t, unsigned int first, unsigned int count, const geometry::ray<float>* r) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 none = _mm256_set1_ps(INFINITY);
+  const __m256 lower = _mm256_set1_ps(lowerTolerance<float>());
+  const __m256 upper = _mm256_set1_ps(upperTolerance<float>());
+  const __m256 Ox = _mm256_set1_ps(r->_O._x), Oy = _mm256_set1_ps(r->_O._y), Oz = _mm256_set1_ps(r->_O._z);
+  const __m256 Dx = _mm256_set1_ps(r->_D._x), Dy = _mm256_set1_ps(r->_D._y), Dz = _mm256_set1_ps(r->_D._z);
+  const __m256i lane_ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  __m256 best = none;
+  for (unsigned int i = 0; i < count; i += 8) {
+    __m256i load_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(count - i)), lane_ids);
+    unsigned int j = first + i;
+    __m256 Ax = _mm256_maskload_ps(&(t->_Ax[j]), load_mask);
+    __m256 Ay = _mm256_maskload_ps(&(t->_Ay[j]), load_mask);
+    __m256 Az = _mm256_maskload_ps(&(t->_Az[j]), load_mask);
+    __m256 E1x = _mm256_maskload_ps(&(t->_E1x[j]), load_mask);
+    __m256 E1y = _mm256_maskload_ps(&(t->_E1y[j]), load_mask);
+    __m256 E1z = _mm256_maskload_ps(&(t->_E1z[j]), load_mask);
+    __m256 E2x = _mm256_maskload_ps(&(t->_E2x[j]), load_mask);
+    __m256 E2y = _mm256_maskload_ps(&(t->_E2y[j]), load_mask);
+    __m256 E2z = _mm256_maskload_ps(&(t->_E2z[j]), load_mask);
+
+    __m256 Tx = _mm256_sub_ps(Ox, Ax);
+    __m256 Ty = _mm256_sub_ps(Oy, Ay);
+    __m256 Tz = _mm256_sub_ps(Oz, Az);
+
+    __m256 Px = _mm256_sub_ps(_mm256_mul_ps(Dy, E2z), _mm256_mul_ps(Dz, E2y));
+    __m256 Py = _mm256_xor_ps(_mm256_sub_ps(_mm256_mul_ps(Dx, E2z), _mm256_mul_ps(Dz, E2x)), sign);
+    __m256 Pz = _mm256_sub_ps(_mm256_mul_ps(Dx, E2y), _mm256_mul_ps(Dy, E2x));
+
+    __m256 Qx = _mm256_sub_ps(_mm256_mul_ps(Ty, E1z), _mm256_mul_ps(Tz, E1y));
+    __m256 Qy = _mm256_xor_ps(_mm256_sub_ps(_mm256_mul_ps(Tx, E1z), _mm256_mul_ps(Tz, E1x)), sign);
+    __m256 Qz = _mm256_sub_ps(_mm256_mul_ps(Tx, E1y), _mm256_mul_ps(Ty, E1x));
+
+    __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Px, E1x), _mm256_mul_ps(Py, E1y)), _mm256_mul_ps(Pz, E1z));
+    __m256 scalar = _mm256_div_ps(one, det);
+
+    __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Px, Tx), _mm256_mul_ps(Py, Ty)), _mm256_mul_ps(Pz, Tz)), scalar);
+    __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Qx, Dx), _mm256_mul_ps(Qy, Dy)), _mm256_mul_ps(Qz, Dz)), scalar);
+    __m256 hit = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Qx, E2x), _mm256_mul_ps(Qy, E2y)), _mm256_mul_ps(Qz, E2z)), scalar);
+
+    __m256 reject = _mm256_or_ps(
+      _mm256_or_ps(_mm256_cmp_ps(u, lower, _CMP_LT_OQ), _mm256_cmp_ps(u, upper, _CMP_GT_OQ)),
+      _mm256_or_ps(_mm256_cmp_ps(v, lower, _CMP_LT_OQ), _mm256_cmp_ps(v, upper, _CMP_GT_OQ)) );
+    __m256 accept = _mm256_andnot_ps(reject, _mm256_cmp_ps(hit, zero, _CMP_GT_OQ));
+    accept = _mm256_and_ps(accept, _mm256_castsi256_ps(load_mask));
+    best = _mm256_min_ps(best, _mm256_blendv_ps(none, hit, accept));
+  }
+
+  alignas(32) float lanes[8];
+  _mm256_store_ps(lanes, best);
+  return *std::min_element(lanes, lanes + 8);
+}
+
+OVF_TARGET("avx2") inline double leafMinimumAVX2(const geometry::BVHTriangles<double>* t, unsigned int first, unsigned int count, const geometry::ray<double>* r) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d none = _mm256_set1_pd(INFINITY);
+  const __m256d lower = _mm256_set1_pd(lowerTolerance<double>());
+  const __m256d upper = _mm256_set1_pd(upperTolerance<double>());
+  const __m256d Ox = _mm256_set1_pd(r->_O._x), Oy = _mm256_set1_pd(r->_O._y), Oz = _mm256_set1_pd(r->_O._z);
+  const __m256d Dx = _mm256_set1_pd(r->_D._x), Dy = _mm256_set1_pd(r->_D._y), Dz = _mm256_set1_pd(r->_D._z);
+  const __m256i lane_ids = _mm256_setr_epi64x(0, 1, 2, 3);
+
+  __m256d best = none;
+  for (unsigned int i = 0; i < count; i += 4) {
+    __m256i load_mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x((long long)(count - i)), lane_ids);
+    unsigned int j = first + i;
+    __m256d Ax = _mm256_maskload_pd(&(t->_Ax[j]), load_mask);
+    __m256d Ay = _mm256_maskload_pd(&(t->_Ay[j]), load_mask);
+    __m256d Az = _mm256_maskload_pd(&(t->_Az[j]), load_mask);
+    __m256d E1x = _mm256_maskload_pd(&(t->_E1x[j]), load_mask);
+    __m256d E1y = _mm256_maskload_pd(&(t->_E1y[j]), load_mask);
+    __m256d E1z = _mm256_maskload_pd(&(t->_E1z[j]), load_mask);
+    __m256d E2x = _mm256_maskload_pd(&(t->_E2x[j]), load_mask);
+    __m256d E2y = _mm256_maskload_pd(&(t->_E2y[j]), load_mask);
+    __m256d E2z = _mm256_maskload_pd(&(t->_E2z[j]), load_mask);
+
+    __m256d Tx = _mm256_sub_pd(Ox, Ax);
+    __m256d Ty = _mm256_sub_pd(Oy, Ay);
+    __m256d Tz = _mm256_sub_pd(Oz, Az);
+
+    __m256d Px = _mm256_sub_pd(_mm256_mul_pd(Dy, E2z), _mm256_mul_pd(Dz, E2y));
+    __m256d Py = _mm256_xor_pd(_mm256_sub_pd(_mm256_mul_pd(Dx, E2z), _mm256_mul_pd(Dz, E2x)), sign);
+    __m256d Pz = _mm256_sub_pd(_mm256_mul_pd(Dx, E2y), _mm256_mul_pd(Dy, E2x));
+
+    __m256d Qx = _mm256_sub_pd(_mm256_mul_pd(Ty, E1z), _mm256_mul_pd(Tz, E1y));
+    __m256d Qy = _mm256_xor_pd(_mm256_sub_pd(_mm256_mul_pd(Tx, E1z), _mm256_mul_pd(Tz, E1x)), sign);
+    __m256d Qz = _mm256_sub_pd(_mm256_mul_pd(Tx, E1y), _mm256_mul_pd(Ty, E1x));
+
+    __m256d det = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Px, E1x), _mm256_mul_pd(Py, E1y)), _mm256_mul_pd(Pz, E1z));
+    __m256d scalar = _mm256_div_pd(one, det);
+
+    __m256d u = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Px, Tx), _mm256_mul_pd(Py, Ty)), _mm256_mul_pd(Pz, Tz)), scalar);
+    __m256d v = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Qx, Dx), _mm256_mul_pd(Qy, Dy)), _mm256_mul_pd(Qz, Dz)), scalar);
+    __m256d hit = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Qx, E2x), _mm256_mul_pd(Qy, E2y)), _mm256_mul_pd(Qz, E2z)), scalar);
+
+    __m256d reject = _mm256_or_pd(
+      _mm256_or_pd(_mm256_cmp_pd(u, lower, _CMP_LT_OQ), _mm256_cmp_pd(u, upper, _CMP_GT_OQ)),
+      _mm256_or_pd(_mm256_cmp_pd(v, lower, _CMP_LT_OQ), _mm256_cmp_pd(v, upper, _CMP_GT_OQ)) );
+    __m256d accept = _mm256_andnot_pd(reject, _mm256_cmp_pd(hit, zero, _CMP_GT_OQ));
+    accept = _mm256_and_pd(accept, _mm256_castsi256_pd(load_mask));
+    best = _mm256_min_pd(best, _mm256_blendv_pd(none, hit, accept));
+  }
+
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, best);
+  return *std::min_element(lanes, lanes + 4);
+}
+
+OVF_TARGET("avx512f") inline float leafMinimumAVX512(const geometry::BVHTriangles<float>* t, unsigned int first, unsigned int count, const geometry::ray<float>* r) {
+  const __m512i sign = _mm512_set1_epi32((int)0x80000000);
+  const __m512 one = _mm512_set1_ps(1.0f);
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 lower = _mm512_set1_ps(lowerTolerance<float>());
+  const __m512 upper = _mm512_set1_ps(upperTolerance<float>());
+  const __m512 Ox = _mm512_set1_ps(r->_O._x), Oy = _mm512_set1_ps(r->_O._y), Oz = _mm512_set1_ps(r->_O._z);
+  const __m512 Dx = _mm512_set1_ps(r->_D._x), Dy = _mm512_set1_ps(r->_D._y), Dz = _mm512_set1_ps(r->_D._z);
+
+  __m512 best = _mm512_set1_ps(INFINITY);
+  for (unsigned int i = 0; i < count; i += 16) {
+    unsigned int remaining = std::min(count - i, 16u);
+    __mmask16 load_mask = (__mmask16)((remaining == 16) ? 0xFFFF : ((1u << remaining) - 1));
+    unsigned int j = first + i;
+    __m512 Ax = _mm512_maskz_loadu_ps(load_mask, &(t->_Ax[j]));
+    __m512 Ay = _mm512_maskz_loadu_ps(load_mask, &(t->_Ay[j]));
+    __m512 Az = _mm512_maskz_loadu_ps(load_mask, &(t->_Az[j]));
+    __m512 E1x = _mm512_maskz_loadu_ps(load_mask, &(t->_E1x[j]));
+    __m512 E1y = _mm512_maskz_loadu_ps(load_mask, &(t->_E1y[j]));
+    __m512 E1z = _mm512_maskz_loadu_ps(load_mask, &(t->_E1z[j]));
+    __m512 E2x = _mm512_maskz_loadu_ps(load_mask, &(t->_E2x[j]));
+    __m512 E2y = _mm512_maskz_loadu_ps(load_mask, &(t->_E2y[j]));
+    __m512 E2z = _mm512_maskz_loadu_ps(load_mask, &(t->_E2z[j]));
+
+    __m512 Tx = _mm512_sub_ps(Ox, Ax);
+    __m512 Ty = _mm512_sub_ps(Oy, Ay);
+    __m512 Tz = _mm512_sub_ps(Oz, Az);
+
+    __m512 Px = _mm512_sub_ps(_mm512_mul_ps(Dy, E2z), _mm512_mul_ps(Dz, E2y));
+    __m512 Py = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_sub_ps(_mm512_mul_ps(Dx, E2z), _mm512_mul_ps(Dz, E2x))), sign));
+    __m512 Pz = _mm512_sub_ps(_mm512_mul_ps(Dx, E2y), _mm512_mul_ps(Dy, E2x));
+
+    __m512 Qx = _mm512_sub_ps(_mm512_mul_ps(Ty, E1z), _mm512_mul_ps(Tz, E1y));
+    __m512 Qy = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_sub_ps(_mm512_mul_ps(Tx, E1z), _mm512_mul_ps(Tz, E1x))), sign));
+    __m512 Qz = _mm512_sub_ps(_mm512_mul_ps(Tx, E1y), _mm512_mul_ps(Ty, E1x));
+
+    __m512 det = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(Px, E1x), _mm512_mul_ps(Py, E1y)), _mm512_mul_ps(Pz, E1z));
+    __m512 scalar = _mm512_div_ps(one, det);
+
+    __m512 u = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(Px, Tx), _mm512_mul_ps(Py, Ty)), _mm512_mul_ps(Pz, Tz)), scalar);
+    __m512 v = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(Qx, Dx), _mm512_mul_ps(Qy, Dy)), _mm512_mul_ps(Qz, Dz)), scalar);
+    __m512 hit = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(Qx, E2x), _mm512_mul_ps(Qy, E2y)), _mm512_mul_ps(Qz, E2z)), scalar);
+
+    __mmask16 reject = _mm512_cmp_ps_mask(u, lower, _CMP_LT_OQ) | _mm512_cmp_ps_mask(u, upper, _CMP_GT_OQ)
+                     | _mm512_cmp_ps_mask(v, lower, _CMP_LT_OQ) | _mm512_cmp_ps_mask(v, upper, _CMP_GT_OQ);
+    __mmask16 accept = (__mmask16)(~reject & _mm512_cmp_ps_mask(hit, zero, _CMP_GT_OQ) & load_mask);
+    best = _mm512_mask_min_ps(best, accept, best, hit);
+  }
+  alignas(64) float lanes[16];
+  _mm512_store_ps(lanes, best);
+  return *std::min_element(lanes, lanes + 16);
+}
+
+OVF_TARGET("avx512f") inline double leafMinimumAVX512(const geometry::BVHTriangles<double>* t, unsigned int first, unsigned int count, const geometry::ray<double>* r) {
+  const __m512i sign = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+  const __m512d one = _mm512_set1_pd(1.0);
+  const __m512d zero = _mm512_setzero_pd();
+  const __m512d lower = _mm512_set1_pd(lowerTolerance<double>());
+  const __m512d upper = _mm512_set1_pd(upperTolerance<double>());
+  const __m512d Ox = _mm512_set1_pd(r->_O._x), Oy = _mm512_set1_pd(r->_O._y), Oz = _mm512_set1_pd(r->_O._z);
+  const __m512d Dx = _mm512_set1_pd(r->_D._x), Dy = _mm512_set1_pd(r->_D._y), Dz = _mm512_set1_pd(r->_D._z);
+
+  __m512d best = _mm512_set1_pd(INFINITY);
+  for (unsigned int i = 0; i < count; i += 8) {
+    unsigned int remaining = std::min(count - i, 8u);
+    __mmask8 load_mask = (__mmask8)((remaining == 8) ? 0xFF : ((1u << remaining) - 1));
+    unsigned int j = first + i;
+    __m512d Ax = _mm512_maskz_loadu_pd(load_mask, &(t->_Ax[j]));
+    __m512d Ay = _mm512_maskz_loadu_pd(load_mask, &(t->_Ay[j]));
+    __m512d Az = _mm512_maskz_loadu_pd(load_mask, &(t->_Az[j]));
+    __m512d E1x = _mm512_maskz_loadu_pd(load_mask, &(t->_E1x[j]));
+    __m512d E1y = _mm512_maskz_loadu_pd(load_mask, &(t->_E1y[j]));
+    __m512d E1z = _mm512_maskz_loadu_pd(load_mask, &(t->_E1z[j]));
+    __m512d E2x = _mm512_maskz_loadu_pd(load_mask, &(t->_E2x[j]));
+    __m512d E2y = _mm512_maskz_loadu_pd(load_mask, &(t->_E2y[j]));
+    __m512d E2z = _mm512_maskz_loadu_pd(load_mask, &(t->_E2z[j]));
+
+    __m512d Tx = _mm512_sub_pd(Ox, Ax);
+    __m512d Ty = _mm512_sub_pd(Oy, Ay);
+    __m512d Tz = _mm512_sub_pd(Oz, Az);
+
+    __m512d Px = _mm512_sub_pd(_mm512_mul_pd(Dy, E2z), _mm512_mul_pd(Dz, E2y));
+    __m512d Py = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_sub_pd(_mm512_mul_pd(Dx, E2z), _mm512_mul_pd(Dz, E2x))), sign));
+    __m512d Pz = _mm512_sub_pd(_mm512_mul_pd(Dx, E2y), _mm512_mul_pd(Dy, E2x));
+
+    __m512d Qx = _mm512_sub_pd(_mm512_mul_pd(Ty, E1z), _mm512_mul_pd(Tz, E1y));
+    __m512d Qy = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_sub_pd(_mm512_mul_pd(Tx, E1z), _mm512_mul_pd(Tz, E1x))), sign));
+    __m512d Qz = _mm512_sub_pd(_mm512_mul_pd(Tx, E1y), _mm512_mul_pd(Ty, E1x));
+
+    __m512d det = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Px, E1x), _mm512_mul_pd(Py, E1y)), _mm512_mul_pd(Pz, E1z));
+    __m512d scalar = _mm512_div_pd(one, det);
+
+    __m512d u = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Px, Tx), _mm512_mul_pd(Py, Ty)), _mm512_mul_pd(Pz, Tz)), scalar);
+    __m512d v = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Qx, Dx), _mm512_mul_pd(Qy, Dy)), _mm512_mul_pd(Qz, Dz)), scalar);
+    __m512d hit = _mm512_mul_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Qx, E2x), _mm512_mul_pd(Qy, E2y)), _mm512_mul_pd(Qz, E2z)), scalar);
+
+    __mmask8 reject = _mm512_cmp_pd_mask(u, lower, _CMP_LT_OQ) | _mm512_cmp_pd_mask(u, upper, _CMP_GT_OQ)
+                    | _mm512_cmp_pd_mask(v, lower, _CMP_LT_OQ) | _mm512_cmp_pd_mask(v, upper, _CMP_GT_OQ);
+    __mmask8 accept = (__mmask8)(~reject & _mm512_cmp_pd_mask(hit, zero, _CMP_GT_OQ) & load_mask);
+    best = _mm512_mask_min_pd(best, accept, best, hit);
+  }
+  alignas(64) double lanes[8];
+  _mm512_store_pd(lanes, best);
+  return *std::min_element(lanes, lanes + 8);
+}
+
+//* ----- VIEW FACTOR KERNELS ----- *//
+
+//* gcc 12 reports the undefined vectors inside its own AVX-512 intrinsics as maybe-uninitialized
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+//* Each row kernel evaluates one emitter against count receivers picked out of the receiver data
+//* by column index, writes values[0..n) for the first n = count rounded down to whole vectors and
+//* returns n, the caller finishes the tail with the scalar kernels. DAI follows the scalar
+//* operations one-for-one (float rounds its pi product and reciprocal through double the way the
+//* scalar promotion does) so it is bitwise identical; SAI uses the vector atan below and agrees
+//* with the scalar result to a few ulp.
+
+//* atan after Cephes: fold onto [0, tan(pi/8)] or [0, 0.66] around 0, pi/4 or pi/2, then a polynomial
+OVF_TARGET("avx2") inline __m256 atanAVX2(__m256 a) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  __m256 x = _mm256_andnot_ps(sign, a);
+  __m256 big = _mm256_cmp_ps(x, _mm256_set1_ps(2.414213562373095f), _CMP_GT_OQ);
+  __m256 mid = _mm256_andnot_ps(big, _mm256_cmp_ps(x, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OQ));
+  __m256 y = _mm256_or_ps(_mm256_and_ps(big, _mm256_set1_ps((float)(std::numbers::pi * 0.5))), _mm256_and_ps(mid, _mm256_set1_ps((float)(std::numbers::pi * 0.25))));
+  x = _mm256_blendv_ps(x, _mm256_div_ps(_mm256_sub_ps(x, one), _mm256_add_ps(x, one)), mid);
+  x = _mm256_blendv_ps(x, _mm256_xor_ps(_mm256_div_ps(one, x), sign), big);
+  __m256 z = _mm256_mul_ps(x, x);
+  __m256 p = _mm256_set1_ps(8.05374449538e-2f);
+  p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(-1.38776856032e-1f));
+  p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(1.99777106478e-1f));
+  p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(-3.33329491539e-1f));
+  y = _mm256_add_ps(y, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(p, z), x), x));
+  return _mm256_or_ps(y, _mm256_and_ps(a, sign));
+}
+
+OVF_TARGET("avx2") inline __m256d atanAVX2(__m256d a) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d one = _mm256_set1_pd(1.0);
+  const double more_bits = 6.123233995736765886130e-17;
+  __m256d x = _mm256_andnot_pd(sign, a);
+  __m256d big = _mm256_cmp_pd(x, _mm256_set1_pd(2.41421356237309504880), _CMP_GT_OQ);
+  __m256d mid = _mm256_andnot_pd(big, _mm256_cmp_pd(x, _mm256_set1_pd(0.66), _CMP_GT_OQ));
+  __m256d y = _mm256_or_pd(_mm256_and_pd(big, _mm256_set1_pd(std::numbers::pi * 0.5)), _mm256_and_pd(mid, _mm256_set1_pd(std::numbers::pi * 0.25)));
+  __m256d extra = _mm256_or_pd(_mm256_and_pd(big, _mm256_set1_pd(more_bits)), _mm256_and_pd(mid, _mm256_set1_pd(0.5 * more_bits)));
+  x = _mm256_blendv_pd(x, _mm256_div_pd(_mm256_sub_pd(x, one), _mm256_add_pd(x, one)), mid);
+  x = _mm256_blendv_pd(x, _mm256_xor_pd(_mm256_div_pd(one, x), sign), big);
+  __m256d z = _mm256_mul_pd(x, x);
+  __m256d p = _mm256_set1_pd(-8.750608600031904122785e-1);
+  p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-1.615753718733365076637e1));
+  p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-7.500855792314704667340e1));
+  p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-1.228866684490136173410e2));
+  p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(-6.485021904942025371773e1));
+  __m256d q = _mm256_add_pd(z, _mm256_set1_pd(2.485846490142306297962e1));
+  q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(1.650270098316988542046e2));
+  q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(4.328810604912902668951e2));
+  q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(4.853903996359136964868e2));
+  q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(1.945506571482613964425e2));
+  z = _mm256_div_pd(_mm256_mul_pd(z, p), q);
+  z = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, z), x), extra);
+  y = _mm256_add_pd(y, z);
+  return _mm256_or_pd(y, _mm256_and_pd(a, sign));
+}
+
+OVF_TARGET("avx512f") inline __m512 atanAVX512(__m512 a) {
+  const __m512i sign = _mm512_set1_epi32((int)0x80000000);
+  const __m512 one = _mm512_set1_ps(1.0f);
+  __m512i a_bits = _mm512_castps_si512(a);
+  __m512 x = _mm512_castsi512_ps(_mm512_andnot_si512(sign, a_bits));
+  __mmask16 big = _mm512_cmp_ps_mask(x, _mm512_set1_ps(2.414213562373095f), _CMP_GT_OQ);
+  __mmask16 mid = (__mmask16)(~big & _mm512_cmp_ps_mask(x, _mm512_set1_ps(0.4142135623730950f), _CMP_GT_OQ));
+  __m512 y = _mm512_setzero_ps();
+  y = _mm512_mask_mov_ps(y, big, _mm512_set1_ps((float)(std::numbers::pi * 0.5)));
+  y = _mm512_mask_mov_ps(y, mid, _mm512_set1_ps((float)(std::numbers::pi * 0.25)));
+  x = _mm512_mask_div_ps(x, mid, _mm512_sub_ps(x, one), _mm512_add_ps(x, one));
+  x = _mm512_mask_div_ps(x, big, _mm512_set1_ps(-1.0f), x);
+  __m512 z = _mm512_mul_ps(x, x);
+  __m512 p = _mm512_set1_ps(8.05374449538e-2f);
+  p = _mm512_add_ps(_mm512_mul_ps(p, z), _mm512_set1_ps(-1.38776856032e-1f));
+  p = _mm512_add_ps(_mm512_mul_ps(p, z), _mm512_set1_ps(1.99777106478e-1f));
+  p = _mm512_add_ps(_mm512_mul_ps(p, z), _mm512_set1_ps(-3.33329491539e-1f));
+  y = _mm512_add_ps(y, _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(p, z), x), x));
+  return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(y), _mm512_and_si512(a_bits, sign)));
+}
+
+OVF_TARGET("avx512f") inline __m512d atanAVX512(__m512d a) {
+  const __m512i sign = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+  const __m512d one = _mm512_set1_pd(1.0);
+  const double more_bits = 6.123233995736765886130e-17;
+  __m512i a_bits = _mm512_castpd_si512(a);
+  __m512d x = _mm512_castsi512_pd(_mm512_andnot_si512(sign, a_bits));
+  __mmask8 big = _mm512_cmp_pd_mask(x, _mm512_set1_pd(2.41421356237309504880), _CMP_GT_OQ);
+  __mmask8 mid = (__mmask8)(~big & _mm512_cmp_pd_mask(x, _mm512_set1_pd(0.66), _CMP_GT_OQ));
+  __m512d y = _mm512_setzero_pd();
+  y = _mm512_mask_mov_pd(y, big, _mm512_set1_pd(std::numbers::pi * 0.5));
+  y = _mm512_mask_mov_pd(y, mid, _mm512_set1_pd(std::numbers::pi * 0.25));
+  __m512d extra = _mm512_setzero_pd();
+  extra = _mm512_mask_mov_pd(extra, big, _mm512_set1_pd(more_bits));
+  extra = _mm512_mask_mov_pd(extra, mid, _mm512_set1_pd(0.5 * more_bits));
+  x = _mm512_mask_div_pd(x, mid, _mm512_sub_pd(x, one), _mm512_add_pd(x, one));
+  x = _mm512_mask_div_pd(x, big, _mm512_set1_pd(-1.0), x);
+  __m512d z = _mm512_mul_pd(x, x);
+  __m512d p = _mm512_set1_pd(-8.750608600031904122785e-1);
+  p = _mm512_add_pd(_mm512_mul_pd(p, z), _mm512_set1_pd(-1.615753718733365076637e1));
+  p = _mm512_add_pd(_mm512_mul_pd(p, z), _mm512_set1_pd(-7.500855792314704667340e1));
+  p = _mm512_add_pd(_mm512_mul_pd(p, z), _mm512_set1_pd(-1.228866684490136173410e2));
+  p = _mm512_add_pd(_mm512_mul_pd(p, z), _mm512_set1_pd(-6.485021904942025371773e1));
+  __m512d q = _mm512_add_pd(z, _mm512_set1_pd(2.485846490142306297962e1));
+  q = _mm512_add_pd(_mm512_mul_pd(q, z), _mm512_set1_pd(1.650270098316988542046e2));
+  q = _mm512_add_pd(_mm512_mul_pd(q, z), _mm512_set1_pd(4.328810604912902668951e2));
+  q = _mm512_add_pd(_mm512_mul_pd(q, z), _mm512_set1_pd(4.853903996359136964868e2));
+  q = _mm512_add_pd(_mm512_mul_pd(q, z), _mm512_set1_pd(1.945506571482613964425e2));
+  z = _mm512_div_pd(_mm512_mul_pd(z, p), q);
+  z = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(x, z), x), extra);
+  y = _mm512_add_pd(y, z);
+  return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(y), _mm512_and_si512(a_bits, sign)));
+}
+
+//* -1 / (d^4 pi) of the DAI kernel, float lanes go through double exactly like the scalar promotion
+OVF_TARGET("avx2") inline __m256 daiScaleAVX2(__m256 d4) {
+  const __m256d pi = _mm256_set1_pd(std::numbers::pi);
+  const __m256d minus_one = _mm256_set1_pd(-1.0);
+  __m128 low = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(d4)), pi));
+  __m128 high = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(d4, 1)), pi));
+  low = _mm256_cvtpd_ps(_mm256_div_pd(minus_one, _mm256_cvtps_pd(low)));
+  high = _mm256_cvtpd_ps(_mm256_div_pd(minus_one, _mm256_cvtps_pd(high)));
+  return _mm256_set_m128(high, low);
+}
+
+OVF_TARGET("avx2") inline __m256d daiScaleAVX2(__m256d d4) {
+  return _mm256_div_pd(_mm256_set1_pd(-1.0), _mm256_mul_pd(d4, _mm256_set1_pd(std::numbers::pi)));
+}
+
+OVF_TARGET("avx512f") inline __m512 daiScaleAVX512(__m512 d4) {
+  const __m512d pi = _mm512_set1_pd(std::numbers::pi);
+  const __m512d minus_one = _mm512_set1_pd(-1.0);
+  __m256 low = _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(d4)), pi));
+  __m256 high = _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(d4), 1))), pi));
+  low = _mm512_cvtpd_ps(_mm512_div_pd(minus_one, _mm512_cvtps_pd(low)));
+  high = _mm512_cvtpd_ps(_mm512_div_pd(minus_one, _mm512_cvtps_pd(high)));
+  return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(low)), _mm256_castps_pd(high), 1));
+}
+
+OVF_TARGET("avx512f") inline __m512d daiScaleAVX512(__m512d d4) {
+  return _mm512_div_pd(_mm512_set1_pd(-1.0), _mm512_mul_pd(d4, _mm512_set1_pd(std::numbers::pi)));
+}
+
+OVF_TARGET("avx2") inline size_t daiRowAVX2(geometry::v3<float> e_centroid, geometry::v3<float> e_normal, const geometry::meshData<float>* r, const unsigned int* columns, size_t count, float* values) {
+  const __m256 ex = _mm256_set1_ps(e_centroid._x), ey = _mm256_set1_ps(e_centroid._y), ez = _mm256_set1_ps(e_centroid._z);
+  const __m256 nx = _mm256_set1_ps(e_normal._x), ny = _mm256_set1_ps(e_normal._y), nz = _mm256_set1_ps(e_normal._z);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i index = _mm256_loadu_si256((const __m256i*)(columns + i));
+    __m256 Rx = _mm256_sub_ps(_mm256_i32gather_ps(r->_Cx.data(), index, 4), ex);
+    __m256 Ry = _mm256_sub_ps(_mm256_i32gather_ps(r->_Cy.data(), index, 4), ey);
+    __m256 Rz = _mm256_sub_ps(_mm256_i32gather_ps(r->_Cz.data(), index, 4), ez);
+    __m256 Nx = _mm256_i32gather_ps(r->_Nx.data(), index, 4);
+    __m256 Ny = _mm256_i32gather_ps(r->_Ny.data(), index, 4);
+    __m256 Nz = _mm256_i32gather_ps(r->_Nz.data(), index, 4);
+    __m256 area = _mm256_i32gather_ps(r->_area.data(), index, 4);
+
+    __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Rx, Rx), _mm256_mul_ps(Ry, Ry)), _mm256_mul_ps(Rz, Rz));
+    __m256 scale = daiScaleAVX2(_mm256_mul_ps(d2, d2));
+    __m256 e_dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, Rx), _mm256_mul_ps(ny, Ry)), _mm256_mul_ps(nz, Rz));
+    __m256 r_dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Nx, Rx), _mm256_mul_ps(Ny, Ry)), _mm256_mul_ps(Nz, Rz));
+    _mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(e_dot, r_dot), area), scale));
+  }
+  return i;
+}
+
+OVF_TARGET("avx2") inline size_t daiRowAVX2(geometry::v3<double> e_centroid, geometry::v3<double> e_normal, const geometry::meshData<double>* r, const unsigned int* columns, size_t count, double* values) {
+  const __m256d ex = _mm256_set1_pd(e_centroid._x), ey = _mm256_set1_pd(e_centroid._y), ez = _mm256_set1_pd(e_centroid._z);
+  const __m256d nx = _mm256_set1_pd(e_normal._x), ny = _mm256_set1_pd(e_normal._y), nz = _mm256_set1_pd(e_normal._z);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i index = _mm_loadu_si128((const __m128i*)(columns + i));
+    __m256d Rx = _mm256_sub_pd(_mm256_i32gather_pd(r->_Cx.data(), index, 8), ex);
+    __m256d Ry = _mm256_sub_pd(_mm256_i32gather_pd(r->_Cy.data(), index, 8), ey);
+    __m256d Rz = _mm256_sub_pd(_mm256_i32gather_pd(r->_Cz.data(), index, 8), ez);
+    __m256d Nx = _mm256_i32gather_pd(r->_Nx.data(), index, 8);
+    __m256d Ny = _mm256_i32gather_pd(r->_Ny.data(), index, 8);
+    __m256d Nz = _mm256_i32gather_pd(r->_Nz.data(), index, 8);
+    __m256d area = _mm256_i32gather_pd(r->_area.data(), index, 8);
+
+    __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Rx, Rx), _mm256_mul_pd(Ry, Ry)), _mm256_mul_pd(Rz, Rz));
+    __m256d scale = daiScaleAVX2(_mm256_mul_pd(d2, d2));
+    __m256d e_dot = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(nx, Rx), _mm256_mul_pd(ny, Ry)), _mm256_mul_pd(nz, Rz));
+    __m256d r_dot = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Nx, Rx), _mm256_mul_pd(Ny, Ry)), _mm256_mul_pd(Nz, Rz));
+    _mm256_storeu_pd(values + i, _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(e_dot, r_dot), area), scale));
+  }
+  return i;
+}
+
+OVF_TARGET("avx512f") inline size_t daiRowAVX512(geometry::v3<float> e_centroid, geometry::v3<float> e_normal, const geometry::meshData<float>* r, const unsigned int* columns, size_t count, float* values) {
+  const __m512 ex = _mm512_set1_ps(e_centroid._x), ey = _mm512_set1_ps(e_centroid._y), ez = _mm512_set1_ps(e_centroid._z);
+  const __m512 nx = _mm512_set1_ps(e_normal._x), ny = _mm512_set1_ps(e_normal._y), nz = _mm512_set1_ps(e_normal._z);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512i index = _mm512_loadu_si512((const void*)(columns + i));
+    __m512 Rx = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_Cx.data(), 4), ex);
+    __m512 Ry = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_Cy.data(), 4), ey);
+    __m512 Rz = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_Cz.data(), 4), ez);
+    __m512 Nx = _mm512_i32gather_ps(index, r->_Nx.data(), 4);
+    __m512 Ny = _mm512_i32gather_ps(index, r->_Ny.data(), 4);
+    __m512 Nz = _mm512_i32gather_ps(index, r->_Nz.data(), 4);
+    __m512 area = _mm512_i32gather_ps(index, r->_area.data(), 4);
+
+    __m512 d2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(Rx, Rx), _mm512_mul_ps(Ry, Ry)), _mm512_mul_ps(Rz, Rz));
+    __m512 scale = daiScaleAVX512(_mm512_mul_ps(d2, d2));
+    __m512 e_dot = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(nx, Rx), _mm512_mul_ps(ny, Ry)), _mm512_mul_ps(nz, Rz));
+    __m512 r_dot = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(Nx, Rx), _mm512_mul_ps(Ny, Ry)), _mm512_mul_ps(Nz, Rz));
+    _mm512_storeu_ps(values + i, _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(e_dot, r_dot), area), scale));
+  }
+  return i;
+}
+
+OVF_TARGET("avx512f") inline size_t daiRowAVX512(geometry::v3<double> e_centroid, geometry::v3<double> e_normal, const geometry::meshData<double>* r, const unsigned int* columns, size_t count, double* values) {
+  const __m512d ex = _mm512_set1_pd(e_centroid._x), ey = _mm512_set1_pd(e_centroid._y), ez = _mm512_set1_pd(e_centroid._z);
+  const __m512d nx = _mm512_set1_pd(e_normal._x), ny = _mm512_set1_pd(e_normal._y), nz = _mm512_set1_pd(e_normal._z);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i index = _mm256_loadu_si256((const __m256i*)(columns + i));
+    __m512d Rx = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_Cx.data(), 8), ex);
+    __m512d Ry = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_Cy.data(), 8), ey);
+    __m512d Rz = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_Cz.data(), 8), ez);
+    __m512d Nx = _mm512_i32gather_pd(index, r->_Nx.data(), 8);
+    __m512d Ny = _mm512_i32gather_pd(index, r->_Ny.data(), 8);
+    __m512d Nz = _mm512_i32gather_pd(index, r->_Nz.data(), 8);
+    __m512d area = _mm512_i32gather_pd(index, r->_area.data(), 8);
+
+    __m512d d2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Rx, Rx), _mm512_mul_pd(Ry, Ry)), _mm512_mul_pd(Rz, Rz));
+    __m512d scale = daiScaleAVX512(_mm512_mul_pd(d2, d2));
+    __m512d e_dot = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(nx, Rx), _mm512_mul_pd(ny, Ry)), _mm512_mul_pd(nz, Rz));
+    __m512d r_dot = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(Nx, Rx), _mm512_mul_pd(Ny, Ry)), _mm512_mul_pd(Nz, Rz));
+    _mm512_storeu_pd(values + i, _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(e_dot, r_dot), area), scale));
+  }
+  return i;
+}
+
+//* one edge term of the SAI contour integral, the edge running from b to a as seen from the emitter
+OVF_TARGET("avx2") inline __m256 saiEdgeAVX2(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz, __m256 nx, __m256 ny, __m256 nz) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 cx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+  __m256 cy = _mm256_xor_ps(_mm256_sub_ps(_mm256_mul_ps(ax, bz), _mm256_mul_ps(az, bx)), sign);
+  __m256 cz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+  __m256 projection = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+  __m256 scale = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)), _mm256_mul_ps(cz, cz))));
+  __m256 facing = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, nx), _mm256_mul_ps(cy, ny)), _mm256_mul_ps(cz, nz));
+  __m256 angle = _mm256_sub_ps(_mm256_set1_ps((float)(std::numbers::pi * 0.5)), atanAVX2(_mm256_mul_ps(projection, scale)));
+  return _mm256_mul_ps(_mm256_mul_ps(facing, scale), angle);
+}
+
+OVF_TARGET("avx2") inline size_t saiRowAVX2(geometry::v3<float> e_centroid, geometry::v3<float> e_normal, const geometry::meshData<float>* r, const unsigned int* columns, size_t count, float* values) {
+  const __m256 ex = _mm256_set1_ps(e_centroid._x), ey = _mm256_set1_ps(e_centroid._y), ez = _mm256_set1_ps(e_centroid._z);
+  const __m256 nx = _mm256_set1_ps(e_normal._x), ny = _mm256_set1_ps(e_normal._y), nz = _mm256_set1_ps(e_normal._z);
+  const __m256 inverse_two_pi = _mm256_set1_ps((float)(1.0 / (2.0 * std::numbers::pi)));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i index = _mm256_loadu_si256((const __m256i*)(columns + i));
+    __m256 Ax = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[0].data(), index, 4), ex);
+    __m256 Ay = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[1].data(), index, 4), ey);
+    __m256 Az = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[2].data(), index, 4), ez);
+    __m256 Bx = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[3].data(), index, 4), ex);
+    __m256 By = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[4].data(), index, 4), ey);
+    __m256 Bz = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[5].data(), index, 4), ez);
+    __m256 Cx = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[6].data(), index, 4), ex);
+    __m256 Cy = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[7].data(), index, 4), ey);
+    __m256 Cz = _mm256_sub_ps(_mm256_i32gather_ps(r->_p[8].data(), index, 4), ez);
+
+    __m256 edge_integral = saiEdgeAVX2(Bx, By, Bz, Ax, Ay, Az, nx, ny, nz);
+    edge_integral = _mm256_add_ps(edge_integral, saiEdgeAVX2(Cx, Cy, Cz, Bx, By, Bz, nx, ny, nz));
+    edge_integral = _mm256_add_ps(edge_integral, saiEdgeAVX2(Ax, Ay, Az, Cx, Cy, Cz, nx, ny, nz));
+    _mm256_storeu_ps(values + i, _mm256_mul_ps(edge_integral, inverse_two_pi));
+  }
+  return i;
+}
+
+OVF_TARGET("avx2") inline __m256d saiEdgeAVX2(__m256d ax, __m256d ay, __m256d az, __m256d bx, __m256d by, __m256d bz, __m256d nx, __m256d ny, __m256d nz) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  __m256d cx = _mm256_sub_pd(_mm256_mul_pd(ay, bz), _mm256_mul_pd(az, by));
+  __m256d cy = _mm256_xor_pd(_mm256_sub_pd(_mm256_mul_pd(ax, bz), _mm256_mul_pd(az, bx)), sign);
+  __m256d cz = _mm256_sub_pd(_mm256_mul_pd(ax, by), _mm256_mul_pd(ay, bx));
+  __m256d projection = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ax, bx), _mm256_mul_pd(ay, by)), _mm256_mul_pd(az, bz));
+  __m256d scale = _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy)), _mm256_mul_pd(cz, cz))));
+  __m256d facing = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, nx), _mm256_mul_pd(cy, ny)), _mm256_mul_pd(cz, nz));
+  __m256d angle = _mm256_sub_pd(_mm256_set1_pd((std::numbers::pi * 0.5)), atanAVX2(_mm256_mul_pd(projection, scale)));
+  return _mm256_mul_pd(_mm256_mul_pd(facing, scale), angle);
+}
+
+OVF_TARGET("avx2") inline size_t saiRowAVX2(geometry::v3<double> e_centroid, geometry::v3<double> e_normal, const geometry::meshData<double>* r, const unsigned int* columns, size_t count, double* values) {
+  const __m256d ex = _mm256_set1_pd(e_centroid._x), ey = _mm256_set1_pd(e_centroid._y), ez = _mm256_set1_pd(e_centroid._z);
+  const __m256d nx = _mm256_set1_pd(e_normal._x), ny = _mm256_set1_pd(e_normal._y), nz = _mm256_set1_pd(e_normal._z);
+  const __m256d inverse_two_pi = _mm256_set1_pd((1.0 / (2.0 * std::numbers::pi)));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i index = _mm_loadu_si128((const __m128i*)(columns + i));
+    __m256d Ax = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[0].data(), index, 8), ex);
+    __m256d Ay = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[1].data(), index, 8), ey);
+    __m256d Az = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[2].data(), index, 8), ez);
+    __m256d Bx = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[3].data(), index, 8), ex);
+    __m256d By = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[4].data(), index, 8), ey);
+    __m256d Bz = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[5].data(), index, 8), ez);
+    __m256d Cx = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[6].data(), index, 8), ex);
+    __m256d Cy = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[7].data(), index, 8), ey);
+    __m256d Cz = _mm256_sub_pd(_mm256_i32gather_pd(r->_p[8].data(), index, 8), ez);
+
+    __m256d edge_integral = saiEdgeAVX2(Bx, By, Bz, Ax, Ay, Az, nx, ny, nz);
+    edge_integral = _mm256_add_pd(edge_integral, saiEdgeAVX2(Cx, Cy, Cz, Bx, By, Bz, nx, ny, nz));
+    edge_integral = _mm256_add_pd(edge_integral, saiEdgeAVX2(Ax, Ay, Az, Cx, Cy, Cz, nx, ny, nz));
+    _mm256_storeu_pd(values + i, _mm256_mul_pd(edge_integral, inverse_two_pi));
+  }
+  return i;
+}
+
+OVF_TARGET("avx512f") inline __m512 saiEdgeAVX512(__m512 ax, __m512 ay, __m512 az, __m512 bx, __m512 by, __m512 bz, __m512 nx, __m512 ny, __m512 nz) {
+  const __m512i sign = _mm512_set1_epi32((int)0x80000000);
+  __m512 cx = _mm512_sub_ps(_mm512_mul_ps(ay, bz), _mm512_mul_ps(az, by));
+  __m512 cy = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_sub_ps(_mm512_mul_ps(ax, bz), _mm512_mul_ps(az, bx))), sign));
+  __m512 cz = _mm512_sub_ps(_mm512_mul_ps(ax, by), _mm512_mul_ps(ay, bx));
+  __m512 projection = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(ax, bx), _mm512_mul_ps(ay, by)), _mm512_mul_ps(az, bz));
+  __m512 scale = _mm512_div_ps(_mm512_set1_ps(1.0f), _mm512_sqrt_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(cx, cx), _mm512_mul_ps(cy, cy)), _mm512_mul_ps(cz, cz))));
+  __m512 facing = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(cx, nx), _mm512_mul_ps(cy, ny)), _mm512_mul_ps(cz, nz));
+  __m512 angle = _mm512_sub_ps(_mm512_set1_ps((float)(std::numbers::pi * 0.5)), atanAVX512(_mm512_mul_ps(projection, scale)));
+  return _mm512_mul_ps(_mm512_mul_ps(facing, scale), angle);
+}
+
+OVF_TARGET("avx512f") inline size_t saiRowAVX512(geometry::v3<float> e_centroid, geometry::v3<float> e_normal, const geometry::meshData<float>* r, const unsigned int* columns, size_t count, float* values) {
+  const __m512 ex = _mm512_set1_ps(e_centroid._x), ey = _mm512_set1_ps(e_centroid._y), ez = _mm512_set1_ps(e_centroid._z);
+  const __m512 nx = _mm512_set1_ps(e_normal._x), ny = _mm512_set1_ps(e_normal._y), nz = _mm512_set1_ps(e_normal._z);
+  const __m512 inverse_two_pi = _mm512_set1_ps((float)(1.0 / (2.0 * std::numbers::pi)));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512i index = _mm512_loadu_si512((const void*)(columns + i));
+    __m512 Ax = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[0].data(), 4), ex);
+    __m512 Ay = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[1].data(), 4), ey);
+    __m512 Az = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[2].data(), 4), ez);
+    __m512 Bx = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[3].data(), 4), ex);
+    __m512 By = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[4].data(), 4), ey);
+    __m512 Bz = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[5].data(), 4), ez);
+    __m512 Cx = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[6].data(), 4), ex);
+    __m512 Cy = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[7].data(), 4), ey);
+    __m512 Cz = _mm512_sub_ps(_mm512_i32gather_ps(index, r->_p[8].data(), 4), ez);
+
+    __m512 edge_integral = saiEdgeAVX512(Bx, By, Bz, Ax, Ay, Az, nx, ny, nz);
+    edge_integral = _mm512_add_ps(edge_integral, saiEdgeAVX512(Cx, Cy, Cz, Bx, By, Bz, nx, ny, nz));
+    edge_integral = _mm512_add_ps(edge_integral, saiEdgeAVX512(Ax, Ay, Az, Cx, Cy, Cz, nx, ny, nz));
+    _mm512_storeu_ps(values + i, _mm512_mul_ps(edge_integral, inverse_two_pi));
+  }
+  return i;
+}
+
+OVF_TARGET("avx512f") inline __m512d saiEdgeAVX512(__m512d ax, __m512d ay, __m512d az, __m512d bx, __m512d by, __m512d bz, __m512d nx, __m512d ny, __m512d nz) {
+  const __m512i sign = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+  __m512d cx = _mm512_sub_pd(_mm512_mul_pd(ay, bz), _mm512_mul_pd(az, by));
+  __m512d cy = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_sub_pd(_mm512_mul_pd(ax, bz), _mm512_mul_pd(az, bx))), sign));
+  __m512d cz = _mm512_sub_pd(_mm512_mul_pd(ax, by), _mm512_mul_pd(ay, bx));
+  __m512d projection = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(ax, bx), _mm512_mul_pd(ay, by)), _mm512_mul_pd(az, bz));
+  __m512d scale = _mm512_div_pd(_mm512_set1_pd(1.0), _mm512_sqrt_pd(_mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(cx, cx), _mm512_mul_pd(cy, cy)), _mm512_mul_pd(cz, cz))));
+  __m512d facing = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(cx, nx), _mm512_mul_pd(cy, ny)), _mm512_mul_pd(cz, nz));
+  __m512d angle = _mm512_sub_pd(_mm512_set1_pd((std::numbers::pi * 0.5)), atanAVX512(_mm512_mul_pd(projection, scale)));
+  return _mm512_mul_pd(_mm512_mul_pd(facing, scale), angle);
+}
+
+OVF_TARGET("avx512f") inline size_t saiRowAVX512(geometry::v3<double> e_centroid, geometry::v3<double> e_normal, const geometry::meshData<double>* r, const unsigned int* columns, size_t count, double* values) {
+  const __m512d ex = _mm512_set1_pd(e_centroid._x), ey = _mm512_set1_pd(e_centroid._y), ez = _mm512_set1_pd(e_centroid._z);
+  const __m512d nx = _mm512_set1_pd(e_normal._x), ny = _mm512_set1_pd(e_normal._y), nz = _mm512_set1_pd(e_normal._z);
+  const __m512d inverse_two_pi = _mm512_set1_pd((1.0 / (2.0 * std::numbers::pi)));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i index = _mm256_loadu_si256((const __m256i*)(columns + i));
+    __m512d Ax = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[0].data(), 8), ex);
+    __m512d Ay = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[1].data(), 8), ey);
+    __m512d Az = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[2].data(), 8), ez);
+    __m512d Bx = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[3].data(), 8), ex);
+    __m512d By = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[4].data(), 8), ey);
+    __m512d Bz = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[5].data(), 8), ez);
+    __m512d Cx = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[6].data(), 8), ex);
+    __m512d Cy = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[7].data(), 8), ey);
+    __m512d Cz = _mm512_sub_pd(_mm512_i32gather_pd(index, r->_p[8].data(), 8), ez);
+
+    __m512d edge_integral = saiEdgeAVX512(Bx, By, Bz, Ax, Ay, Az, nx, ny, nz);
+    edge_integral = _mm512_add_pd(edge_integral, saiEdgeAVX512(Cx, Cy, Cz, Bx, By, Bz, nx, ny, nz));
+    edge_integral = _mm512_add_pd(edge_integral, saiEdgeAVX512(Ax, Ay, Az, Cx, Cy, Cz, nx, ny, nz));
+    _mm512_storeu_pd(values + i, _mm512_mul_pd(edge_integral, inverse_two_pi));
+  }
+  return i;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+}
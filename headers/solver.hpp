@@ -1,6 +1,9 @@
 #include "all_headers.hpp"
 
+#include "cli.hpp"
 #include "geometry.hpp"
+#include "simd.hpp"
+#include "sparse.hpp"
 
 #pragma once
 
@@ -10,6 +13,47 @@ namespace solver {
 
 namespace geo = geometry;
 
+//* the pair space is walked in 2D tiles, a block of emitters against a block of receivers, so the receiver
+//* data a tile touches stays in cache while every emitter of the block reuses it
+const unsigned int TILE_EMITTERS = 64;
+const unsigned int TILE_RECEIVERS = 1024;
+
+//* runs segment_kernel(e, begin, end) on the stored entries [begin, end) of row e that fall in each tile's
+//* receiver block, tiles are handed out dynamically so uneven rows balance across threads, returns the kernel
+//* results summed. kernels may write values and flags but not the column indices the tiles are found from
+template <typename T, typename F> unsigned long long forEachTile(const sparse::csr<T>* matrix, F segment_kernel) {
+  long long e_tiles = (matrix->_N_rows + TILE_EMITTERS - 1) / TILE_EMITTERS;
+  long long r_tiles = (matrix->_N_cols + TILE_RECEIVERS - 1) / TILE_RECEIVERS;
+  unsigned long long total = 0;
+
+  #pragma omp parallel for collapse(2) schedule(dynamic) reduction(+:total)
+  for (long long e_tile = 0; e_tile < e_tiles; e_tile++) {
+    for (long long r_tile = 0; r_tile < r_tiles; r_tile++) {
+      unsigned int e_first = e_tile * TILE_EMITTERS;
+      unsigned int e_last = std::min(e_first + TILE_EMITTERS, matrix->_N_rows);
+      unsigned int r_first = r_tile * TILE_RECEIVERS;
+      unsigned int r_last = std::min(r_first + TILE_RECEIVERS, matrix->_N_cols);
+
+      for (unsigned int e = e_first; e < e_last; e++) {
+        const unsigned int* columns = matrix->rowColumns(e);
+        const unsigned int* row_end = columns + matrix->rowSize(e);
+        const unsigned int* begin = std::lower_bound(columns, row_end, r_first);
+        const unsigned int* end = std::lower_bound(begin, row_end, r_last);
+        if (begin != end) {
+          total += segment_kernel(e, begin - columns, end - columns);
+        }
+      }
+    }
+  }
+  return total;
+}
+
+//* a symmetric solve only keeps the pairs i < j, so row e of a tile starting at global row first_row begins after
+//* its own global index
+inline unsigned int firstColumn(unsigned int e, unsigned int first_row, bool upper) {
+  return upper ? first_row + e + 1 : 0;
+}
+
 template <typename T> bool backFaceCullElements(geo::v3<T> e_centroid, geo::v3<T> e_normal, geo::v3<T> r_centroid, geo::v3<T> r_normal) {
   geo::v3<T> ray = geo::normalize( r_centroid - e_centroid );
   bool emitter_culled = geo::dot( ray, e_normal ) <= 0.0;
@@ -17,29 +61,207 @@ template <typename T> bool backFaceCullElements(geo::v3<T> e_centroid, geo::v3<T
   return ( emitter_culled || receiver_culled );
 }
 
-template <typename T> void backFaceCullMeshes(std::vector<geo::v3<T>>* e_centroids, std::vector<geo::v3<T>>* e_normals, std::vector<geo::v3<T>>* r_centroids, std::vector<geo::v3<T>>* r_normals, std::vector<std::vector<unsigned int>*>* unculled_indices) {
-  unsigned int N_e = e_centroids->size();
-  unsigned int N_r = r_centroids->size();
-  unsigned int problem_size = N_e * N_r;
+//* builds the sparsity pattern of unculled pairs in two passes, count then fill, each emitter block walks the
+//* receivers one tile at a time so a receiver block is tested against the whole emitter block while cached,
+//* the pattern does not depend on the value type V the matrix is later integrated in
+template <typename T, typename V> void backFaceCullMeshes(const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, sparse::csr<V>* matrix, bool upper = false, unsigned int first_row = 0) {
+  unsigned int N_e = e_data->size();
+  unsigned int N_r = r_data->size();
+  *matrix = sparse::csr<V>(N_e, N_r);
+  int e_tiles = (N_e + TILE_EMITTERS - 1) / TILE_EMITTERS;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int e_tile = 0; e_tile < e_tiles; e_tile++) {
+    unsigned int e_first = e_tile * TILE_EMITTERS;
+    unsigned int e_last = std::min(e_first + TILE_EMITTERS, N_e);
+    for (unsigned int r_first = 0; r_first < N_r; r_first += TILE_RECEIVERS) {
+      unsigned int r_last = std::min(r_first + TILE_RECEIVERS, N_r);
+      for (unsigned int e = e_first; e < e_last; e++) {
+        geo::v3<T> e_centroid = e_data->centroid(e);
+        geo::v3<T> e_normal = e_data->normal(e);
+        size_t num_unculled = 0;
+        const T *Cx = r_data->_Cx.data(), *Cy = r_data->_Cy.data(), *Cz = r_data->_Cz.data();
+        const T *Nx = r_data->_Nx.data(), *Ny = r_data->_Ny.data(), *Nz = r_data->_Nz.data();
+        for (unsigned int r = std::max(r_first, firstColumn(e, first_row, upper)); r < r_last; r++) {
+          if (!backFaceCullElements( e_centroid, e_normal, geo::v3<T>(Cx[r], Cy[r], Cz[r]), geo::v3<T>(Nx[r], Ny[r], Nz[r]) )) {
+            num_unculled++;
+          }
+        }
+        matrix->_row_offsets[e + 1] += num_unculled;
+      }
+    }
+  }
+  matrix->allocateFromCounts();
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int e_tile = 0; e_tile < e_tiles; e_tile++) {
+    unsigned int e_first = e_tile * TILE_EMITTERS;
+    unsigned int e_last = std::min(e_first + TILE_EMITTERS, N_e);
+    std::array<unsigned int*, TILE_EMITTERS> cursors;
+    for (unsigned int e = e_first; e < e_last; e++) {
+      cursors[e - e_first] = matrix->rowColumns(e);
+    }
+    for (unsigned int r_first = 0; r_first < N_r; r_first += TILE_RECEIVERS) {
+      unsigned int r_last = std::min(r_first + TILE_RECEIVERS, N_r);
+      for (unsigned int e = e_first; e < e_last; e++) {
+        geo::v3<T> e_centroid = e_data->centroid(e);
+        geo::v3<T> e_normal = e_data->normal(e);
+        unsigned int*& columns = cursors[e - e_first];
+        const T *Cx = r_data->_Cx.data(), *Cy = r_data->_Cy.data(), *Cz = r_data->_Cz.data();
+        const T *Nx = r_data->_Nx.data(), *Ny = r_data->_Ny.data(), *Nz = r_data->_Nz.data();
+        for (unsigned int r = std::max(r_first, firstColumn(e, first_row, upper)); r < r_last; r++) {
+          if (!backFaceCullElements( e_centroid, e_normal, geo::v3<T>(Cx[r], Cy[r], Cz[r]), geo::v3<T>(Nx[r], Ny[r], Nz[r]) )) {
+            *(columns++) = r;
+          }
+        }
+      }
+    }
+  }
+}
+
+enum ClusterCull { CLUSTER_CULLED, CLUSTER_UNCULLED, CLUSTER_MIXED };
+
+//* a cluster pair is only decided when its bounds clear zero by this fraction of the largest centroid offset,
+//* far wider than the rounding of a single pair's test, so the pattern matches the per-pair cull exactly
+const double CLUSTER_CULL_MARGIN = 1e-4;
 
-  for ( auto sub_indices : (*unculled_indices) ) {
-    std::iota(sub_indices->begin(), sub_indices->end(), 0);
+//* smallest and largest dot(axis, d) over the box of offsets d in [d_min, d_max]
+template <typename T> std::pair<T,T> dotRange(geo::v3<T> axis, geo::v3<T> d_min, geo::v3<T> d_max) {
+  T lo = 0.0, hi = 0.0;
+  for (int i = 0; i < 3; i++) {
+    lo += std::min(axis[i] * d_min[i], axis[i] * d_max[i]);
+    hi += std::max(axis[i] * d_min[i], axis[i] * d_max[i]);
   }
+  return std::make_pair(lo, hi);
+}
 
-  for (int e = 0; e < N_e; e++) {
-    std::vector<unsigned int>* sub_indices = (*unculled_indices)[e];
-    #pragma omp parallel for
-    for (int r = 0; r < N_r; r++) {
-      bool culled = backFaceCullElements( (*e_centroids)[e], (*e_normals)[e], (*r_centroids)[r], (*r_normals)[r] );
-      if (culled) {
-        (*sub_indices)[ r ] = problem_size;
-      }
+//* every centroid offset between the clusters lies in the difference of their boxes and every normal within
+//* _spread of its cone axis, so dot(offset, normal) is dot(offset, axis) give or take |offset| * _spread
+template <typename T> ClusterCull cullClusters(const geo::elementCluster<T>& e, const geo::elementCluster<T>& r) {
+  geo::v3<T> d_min = r._min - e._max;
+  geo::v3<T> d_max = r._max - e._min;
+  T length = geo::magnitude( geo::vectorElementsMaxima(geo::flip(d_min), d_max) );
+  T margin = (T)CLUSTER_CULL_MARGIN * length;
+
+  std::pair<T,T> e_range = dotRange(e._axis, d_min, d_max);
+  std::pair<T,T> r_range = dotRange(r._axis, d_min, d_max);
+  T e_lo = e_range.first - length * e._spread, e_hi = e_range.second + length * e._spread;
+  T r_lo = r_range.first - length * r._spread, r_hi = r_range.second + length * r._spread;
+
+  if (e_hi < -margin || r_lo > margin) { return CLUSTER_CULLED; }
+  if (e_lo > margin && r_hi < -margin) { return CLUSTER_UNCULLED; }
+  return CLUSTER_MIXED;
+}
+
+//* a run of receivers an emitter cluster keeps whole, or has to test element by element when mixed
+class receiverSpan {
+  public:
+  unsigned int _first, _last;
+  bool _mixed;
+};
+
+//* receivers before min_column are never stored for this emitter cluster, so their clusters are skipped untested
+template <typename T> void collectSpans(const geo::clusterTree<T>* r_tree, unsigned int node, const geo::elementCluster<T>& e, unsigned int min_column, std::vector<receiverSpan>* spans) {
+  const geo::elementCluster<T>& r = r_tree->_clusters[node];
+  if (r._last <= min_column) {
+    return;
+  }
+  ClusterCull cull = cullClusters(e, r);
+  if (cull == CLUSTER_CULLED) {
+    return;
+  }
+  if (cull == CLUSTER_UNCULLED) {
+    if (!spans->empty() && !spans->back()._mixed && spans->back()._last == r._first) {
+      spans->back()._last = r._last;
+    } else {
+      spans->push_back({r._first, r._last, false});
     }
-    auto it = std::remove(sub_indices->begin(), sub_indices->end(), problem_size);
-    sub_indices->erase(it, sub_indices->end());
+    return;
+  }
+  if (r.isLeaf()) {
+    spans->push_back({r._first, r._last, true});
+    return;
   }
+  collectSpans(r_tree, r._left, e, min_column, spans);
+  collectSpans(r_tree, r._right, e, min_column, spans);
 }
 
+//* the same pattern as backFaceCullMeshes, but each block of emitters first walks the receiver cluster tree
+//* and whole cluster pairs that face away or toward each other are decided at once, only mixed leaf pairs are
+//* tested element by element. returns how many pairs needed those element tests
+template <typename T, typename V> unsigned long long hierarchicalCullMeshes(const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, const geo::clusterTree<T>* r_tree, sparse::csr<V>* matrix, bool upper = false, unsigned int first_row = 0) {
+  unsigned int N_e = e_data->size();
+  unsigned int N_r = r_data->size();
+  *matrix = sparse::csr<V>(N_e, N_r);
+  if (N_e == 0 || N_r == 0) {
+    return 0;
+  }
+  int e_clusters = (N_e + geo::CLUSTER_LEAF_SIZE - 1) / geo::CLUSTER_LEAF_SIZE;
+  std::vector<std::vector<receiverSpan>> spans(e_clusters);
+  const T *Cx = r_data->_Cx.data(), *Cy = r_data->_Cy.data(), *Cz = r_data->_Cz.data();
+  const T *Nx = r_data->_Nx.data(), *Ny = r_data->_Ny.data(), *Nz = r_data->_Nz.data();
+  unsigned long long element_tests = 0;
+
+  #pragma omp parallel for schedule(dynamic) reduction(+:element_tests)
+  for (int cluster = 0; cluster < e_clusters; cluster++) {
+    unsigned int e_first = cluster * geo::CLUSTER_LEAF_SIZE;
+    unsigned int e_last = std::min(e_first + geo::CLUSTER_LEAF_SIZE, N_e);
+    collectSpans(r_tree, 0, geo::clusterBounds(e_data, e_first, e_last), firstColumn(e_first, first_row, upper), &spans[cluster]);
+    for (unsigned int e = e_first; e < e_last; e++) {
+      geo::v3<T> e_centroid = e_data->centroid(e);
+      geo::v3<T> e_normal = e_data->normal(e);
+      unsigned int min_column = firstColumn(e, first_row, upper);
+      size_t num_unculled = 0;
+      for (const receiverSpan& span : spans[cluster]) {
+        unsigned int span_first = std::max(span._first, min_column);
+        if (span_first >= span._last) {
+          continue;
+        }
+        if (!span._mixed) {
+          num_unculled += span._last - span_first;
+          continue;
+        }
+        element_tests += span._last - span_first;
+        for (unsigned int r = span_first; r < span._last; r++) {
+          if (!backFaceCullElements( e_centroid, e_normal, geo::v3<T>(Cx[r], Cy[r], Cz[r]), geo::v3<T>(Nx[r], Ny[r], Nz[r]) )) {
+            num_unculled++;
+          }
+        }
+      }
+      matrix->_row_offsets[e + 1] = num_unculled;
+    }
+  }
+  matrix->allocateFromCounts();
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int cluster = 0; cluster < e_clusters; cluster++) {
+    unsigned int e_first = cluster * geo::CLUSTER_LEAF_SIZE;
+    unsigned int e_last = std::min(e_first + geo::CLUSTER_LEAF_SIZE, N_e);
+    for (unsigned int e = e_first; e < e_last; e++) {
+      geo::v3<T> e_centroid = e_data->centroid(e);
+      geo::v3<T> e_normal = e_data->normal(e);
+      unsigned int* columns = matrix->rowColumns(e);
+      unsigned int min_column = firstColumn(e, first_row, upper);
+      for (const receiverSpan& span : spans[cluster]) {
+        unsigned int span_first = std::max(span._first, min_column);
+        if (span_first >= span._last) {
+          continue;
+        }
+        if (!span._mixed) {
+          std::iota(columns, columns + (span._last - span_first), span_first);
+          columns += span._last - span_first;
+          continue;
+        }
+        for (unsigned int r = span_first; r < span._last; r++) {
+          if (!backFaceCullElements( e_centroid, e_normal, geo::v3<T>(Cx[r], Cy[r], Cz[r]), geo::v3<T>(Nx[r], Ny[r], Nz[r]) )) {
+            *(columns++) = r;
+          }
+        }
+      }
+    }
+  }
+  return element_tests;
+}
 
 
 
@@ -67,56 +289,214 @@ template <typename T> geo::ray<T> intersectRayWithTri(geo::ray<T>* r, geo::tri<T
   return *r;
 }
 
+template <typename T> void intersectRayWithTri(geo::ray<T>* r, const geo::BVHTriangle<T>& t) {
+  geo::v3<T> T_vec = r->_O - t._A;
+  geo::v3<T> P_vec = geo::cross(r->_D, t._E2);
+  geo::v3<T> Q_vec = geo::cross(T_vec, t._E1);
 
-template <typename T> void naiveBlockingBetweenMeshes(geo::mesh<T>* o, std::vector<geo::v3<T>>* e_centroids, std::vector<geo::tri<T>>* r_triangles, std::vector<std::vector<unsigned int>*>* unculled_indices) {
-  unsigned int problem_size = e_centroids->size() * r_triangles->size();
+  T scalar = 1.0 / geo::dot(P_vec, t._E1);
+
+  T u = geo::dot(P_vec, T_vec) * scalar;
+  if ( u < -0.001 || u > 1.001 ) { return; }
 
-  for (int e = 0; e < unculled_indices->size(); e++) {
-    std::vector<unsigned int>* sub_indices = (*unculled_indices)[e];
-    
-    #pragma omp parallel for
-    for (int i = 0; i < sub_indices->size(); i++) {
-      unsigned int r = (*sub_indices)[i];
+  T v = geo::dot(Q_vec, r->_D) * scalar;
+  if ( v < -0.001 || v > 1.001 ) { return; }
 
-      geo::v3<T> e_centroid = (*e_centroids)[e];
-      geo::tri<T> r_tri = (*r_triangles)[r];
-      geo::v3<T> r_centroid = geo::centroid(r_tri);
+  T intersection = geo::dot(Q_vec, t._E2) * scalar;
+  if (intersection > 0.0 && intersection < r->_t) { r->_t = intersection; }
+}
 
-      geo::v3<T> ray_vector = r_centroid - e_centroid;
-      T ray_length = geo::magnitude(ray_vector);
-      geo::ray<T> cast_ray( e_centroid, geo::normalize(ray_vector) );
+//* nearest hit over a run of leaf triangles, the reference the vector kernels are checked against
+template <typename T> T leafMinimumScalar(const geo::BVHTriangles<T>* triangles, unsigned int first, unsigned int count, const geo::ray<T>* r) {
+  geo::ray<T> probe = *r;
+  probe._t = INFINITY;
+  for (unsigned int i = first; i < first + count; i++) {
+    intersectRayWithTri(&probe, (*triangles)[i]);
+  }
+  return probe._t;
+}
 
-      for (int j = 0; j < o->size(); j++) {
-        intersectRayWithTri(&cast_ray, (*o)[j]);
-        bool blocked = ( cast_ray._t < ray_length );
-        if (blocked) {
-          (*sub_indices)[i] = problem_size;
-          break;
-        }
-      }
+template <typename T> T leafMinimum(const geo::BVHTriangles<T>* triangles, unsigned int first, unsigned int count, const geo::ray<T>* r, simd::Level level) {
+#ifdef OVF_X86_SIMD
+  if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+    if (level == simd::AVX512) { return simd::leafMinimumAVX512(triangles, first, count, r); }
+    if (level == simd::AVX2) { return simd::leafMinimumAVX2(triangles, first, count, r); }
+  }
+#endif
+  return leafMinimumScalar(triangles, first, count, r);
+}
+
+
+//* counters reported after blocking, a ray terminates when its any-hit query finds the first occluder
+class blockingStats {
+  public:
+  unsigned long long _rays_cast;
+  unsigned long long _rays_terminated;
+  unsigned long long _leaf_mismatches;
+  unsigned long long _cache_queries;
+  unsigned long long _cache_hits;
+
+  blockingStats() : _rays_cast(0), _rays_terminated(0), _leaf_mismatches(0), _cache_queries(0), _cache_hits(0) {}
+
+  blockingStats& operator+=(const blockingStats& other) {
+    _rays_cast += other._rays_cast;
+    _rays_terminated += other._rays_terminated;
+    _leaf_mismatches += other._leaf_mismatches;
+    _cache_queries += other._cache_queries;
+    _cache_hits += other._cache_hits;
+    return *this;
+  }
+};
+
+enum Visibility { VISIBILITY_UNKNOWN, VISIBILITY_CLEAR, VISIBILITY_BLOCKED };
+
+//* two bits per element pair, whether its centroid ray has been cast and whether it was blocked, set together
+//* by one atomic or so threads filling and reading the cache never lock. a mesh facing itself keys its pairs
+//* unordered, (a, b) with a <= b, so a ray cast in one direction answers the other
+class visibilityCache {
+  public:
+  unsigned int _N_e;
+  unsigned int _N_r;
+  bool _unordered;
+  uint64_t _hash;
+  std::vector<std::atomic<uint64_t>> _words;
+
+  visibilityCache() : _N_e(0), _N_r(0), _unordered(false), _hash(0) {}
+  visibilityCache(unsigned int N_e, unsigned int N_r, bool unordered, uint64_t hash)
+    : _N_e(N_e), _N_r(N_r), _unordered(unordered), _hash(hash), _words((numPairs() * 2 + 63) / 64) {}
+
+  uint64_t numPairs() const {
+    return _unordered ? (uint64_t)_N_e * (_N_e + 1) / 2 : (uint64_t)_N_e * _N_r;
+  }
+  size_t bytes() const { return _words.size() * sizeof(uint64_t); }
+
+  //* the direction a pair is cast in first, the other one is answered from the cache when it can be
+  bool canonical(unsigned int e, unsigned int r) const { return ( !_unordered || e <= r ); }
+
+  uint64_t pairIndex(unsigned int e, unsigned int r) const {
+    if (!_unordered) {
+      return (uint64_t)e * _N_r + r;
     }
-    auto it = std::remove(sub_indices->begin(), sub_indices->end(), problem_size);
-    sub_indices->erase(it, sub_indices->end());
+    uint64_t a = std::min(e, r), b = std::max(e, r);
+    return a * _N_e - a * (a - 1) / 2 + (b - a);
+  }
+
+  Visibility lookup(unsigned int e, unsigned int r) const {
+    uint64_t bit = 2 * pairIndex(e, r);
+    uint64_t word = _words[bit / 64].load(std::memory_order_relaxed) >> (bit % 64);
+    if (!(word & 1)) { return VISIBILITY_UNKNOWN; }
+    return (word & 2) ? VISIBILITY_BLOCKED : VISIBILITY_CLEAR;
+  }
+
+  void store(unsigned int e, unsigned int r, bool blocked) {
+    uint64_t bit = 2 * pairIndex(e, r);
+    _words[bit / 64].fetch_or( (blocked ? (uint64_t)3 : (uint64_t)1) << (bit % 64), std::memory_order_relaxed );
+  }
+};
+
+//* FNV-1a over raw bytes, chained through seed
+inline uint64_t contentHash(const void* data, size_t bytes, uint64_t seed = 14695981039346656037ull) {
+  const unsigned char* p = (const unsigned char*)data;
+  for (size_t i = 0; i < bytes; i++) {
+    seed = (seed ^ p[i]) * 1099511628211ull;
   }
+  return seed;
 }
 
+//* long double carries padding bytes with no defined content, so it is hashed through double
+template <typename T> uint64_t hashValues(const std::vector<T>* values, uint64_t seed) {
+  if constexpr (sizeof(T) > sizeof(double)) {
+    for (T value : *values) {
+      double narrowed = (double)value;
+      seed = contentHash(&narrowed, sizeof(double), seed);
+    }
+    return seed;
+  } else {
+    return contentHash(values->data(), values->size() * sizeof(T), seed);
+  }
+}
 
+//* everything a cached ray depends on: both ends' centroids, the blocking triangles, the blocking method and the
+//* precision it ran in
+template <typename T, typename B> uint64_t visibilityHash(const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, const geo::mesh<B>* blockers, cli::BlockingMode mode) {
+  uint64_t hash = contentHash(&mode, sizeof(mode));
+  size_t sizes[2] = { sizeof(T), sizeof(B) };
+  hash = contentHash(sizes, sizeof(sizes), hash);
+  for (const geo::meshData<T>* data : { e_data, r_data }) {
+    for (const std::vector<T>* component : { &data->_Cx, &data->_Cy, &data->_Cz }) {
+      hash = hashValues(component, hash);
+    }
+  }
+  hash = hashValues(&blockers->_p, hash);
+  hash = contentHash(blockers->_c.data(), blockers->_c.size() * sizeof(size_t), hash);
+  return hash;
+}
 
-template <typename T> T intersectRayWithNode(geo::ray<T>* r, geo::BVHNode<T>* b) {
-  T tx1 = (b->min()[0] - r->_O[0]) * r->_invD[0];
-  T tx2 = (b->max()[0] - r->_O[0]) * r->_invD[0];
+//* everything a built tree depends on: the blocking triangles, the builder, the precision and the depth limit
+template <typename B> uint64_t bvhHash(const geo::mesh<B>* blockers, cli::BVHConstructionMode mode) {
+  uint64_t hash = contentHash(&mode, sizeof(mode));
+  size_t sizes[2] = { sizeof(B), geo::BVH_MAX_DEPTH };
+  hash = contentHash(sizes, sizeof(sizes), hash);
+  hash = hashValues(&blockers->_p, hash);
+  hash = contentHash(blockers->_c.data(), blockers->_c.size() * sizeof(size_t), hash);
+  return hash;
+}
+
+//* any-hit query, whether any triangle of the mesh lies between origin and target
+template <typename T> bool occluded(geo::mesh<T>* o, geo::v3<T> origin, geo::v3<T> target) {
+  geo::v3<T> ray_vector = target - origin;
+  T t_max = geo::magnitude(ray_vector);
+  geo::ray<T> r( origin, geo::normalize(ray_vector) );
+  r._t = t_max;
+
+  for (int j = 0; j < o->size(); j++) {
+    intersectRayWithTri(&r, (*o)[j]);
+    if (r._t < t_max) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//* blocked pairs are flagged while the tiles run and removed from the pattern afterwards
+template <typename T, typename V> blockingStats naiveBlockingBetweenMeshes(geo::mesh<T>* o, const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, sparse::csr<V>* matrix) {
+  std::vector<unsigned char> blocked(matrix->nnz(), 0);
+  blockingStats stats;
+  stats._rays_cast = matrix->nnz();
+
+  stats._rays_terminated = forEachTile(matrix, [&](unsigned int e, size_t begin, size_t end) -> unsigned long long {
+    const unsigned int* columns = matrix->rowColumns(e);
+    unsigned char* row_blocked = blocked.data() + matrix->_row_offsets[e];
+    unsigned long long terminated = 0;
+    for (size_t i = begin; i < end; i++) {
+      if (occluded(o, e_data->centroid(e), r_data->centroid(columns[i]))) {
+        row_blocked[i] = 1;
+        terminated++;
+      }
+    }
+    return terminated;
+  });
+  matrix->removeEntries(blocked);
+  return stats;
+}
+
+
+
+template <typename T> T intersectRayWithNode(geo::ray<T>* r, const geo::BVHCompactNode* b) {
+  T tx1 = ((T)b->_bbmin[0] - r->_O._x) * r->_invD._x;
+  T tx2 = ((T)b->_bbmax[0] - r->_O._x) * r->_invD._x;
 
   T tmin = std::min(tx1, tx2);
   T tmax = std::max(tx1, tx2);
 
-  T ty1 = (b->min()[1] - r->_O[1]) * r->_invD[1];
-  T ty2 = (b->max()[1] - r->_O[1]) * r->_invD[1];
+  T ty1 = ((T)b->_bbmin[1] - r->_O._y) * r->_invD._y;
+  T ty2 = ((T)b->_bbmax[1] - r->_O._y) * r->_invD._y;
 
   tmin = std::max(tmin, std::min(ty1, ty2));
   tmax = std::min(tmax, std::max(ty1, ty2));
 
-  T tz1 = (b->min()[2] - r->_O[2]) * r->_invD[2];
-  T tz2 = (b->max()[2] - r->_O[2]) * r->_invD[2];
+  T tz1 = ((T)b->_bbmin[2] - r->_O._z) * r->_invD._z;
+  T tz2 = ((T)b->_bbmax[2] - r->_O._z) * r->_invD._z;
 
   tmin = std::max(tmin, std::min(tz1, tz2));
   tmax = std::min(tmax, std::max(tz1, tz2));
@@ -124,81 +504,263 @@ template <typename T> T intersectRayWithNode(geo::ray<T>* r, geo::BVHNode<T>* b)
   if (tmax >= tmin && tmin < r->_t && tmax > 0.0) return tmin; else return INFINITY;
 }
 
-template <typename T> void intersectRayWithBVH(geo::ray<T>* r, geo::BVH<T> bvh, geo::mesh<T>* m, T triangle_distance) {
-  geo::BVHNode<T>* node = bvh[0];
-  std::vector<geo::BVHNode<T>*> stack(bvh._nodes_used);
+//* nearest hit in one leaf through the selected kernel, optionally checked against the scalar kernel
+template <typename T> T intersectRayWithLeaf(geo::ray<T>* r, const geo::BVH<T>& bvh, const geo::BVHCompactNode* node, simd::Level level, unsigned long long* mismatches) {
+  T leaf_t = leafMinimum(&(bvh._triangles), node->firstTriangleIndex(), node->numTri(), r, level);
+  if (mismatches != nullptr) {
+    T reference_t = leafMinimumScalar(&(bvh._triangles), node->firstTriangleIndex(), node->numTri(), r);
+    if (std::memcmp(&leaf_t, &reference_t, sizeof(T)) != 0) {
+      #pragma omp atomic
+      (*mismatches)++;
+    }
+  }
+  return leaf_t;
+}
+
+//* any-hit query through the BVH, the first triangle found between origin and target ends the traversal,
+//* so children are visited in whatever order they are pushed
+template <typename T> bool occluded(const geo::BVH<T>& bvh, geo::v3<T> origin, geo::v3<T> target, simd::Level level, unsigned long long* mismatches) {
+  geo::v3<T> ray_vector = target - origin;
+  T t_max = geo::magnitude(ray_vector);
+  geo::ray<T> r( origin, geo::normalize(ray_vector) );
+  r._t = t_max;
+
+  const geo::BVHCompactPair* pairs = bvh._pairs;
+  const geo::BVHCompactNode* node = &(pairs[0]._nodes[0]);
+  //* one pending sibling per level plus both children of the deepest interior node
+  std::array<const geo::BVHCompactNode*, geo::BVH_MAX_DEPTH + 1> stack;
   unsigned int stack_pointer = 0;
-  
+
   while (1) {
     if (node->isLeaf()) {
-      for (int i = 0; i < node->numTri(); i++) {
-        const geo::tri<T>& triangle = (*m)[ (bvh._tri_indices)[ (int)(node->firstTriangleIndex()) + i ] ];
-        intersectRayWithTri(r, triangle);
-        if (r->_t < triangle_distance && r->_t > 0.0) {
-          return;
+      if (level == simd::SCALAR) {
+        for (unsigned int i = node->firstTriangleIndex(); i < node->firstTriangleIndex() + node->numTri(); i++) {
+          intersectRayWithTri(&r, bvh._triangles[i]);
+          if (r._t < t_max) {
+            return true;
+          }
         }
+      } else if (intersectRayWithLeaf(&r, bvh, node, level, mismatches) < t_max) {
+        return true;
       }
-      if (stack_pointer == 0) {
+    } else {
+      const geo::BVHCompactPair* children = &(pairs[node->childIndex()]);
+      if (intersectRayWithNode(&r, &(children->_nodes[1])) != INFINITY) {
+        stack[stack_pointer++] = &(children->_nodes[1]);
+      }
+      if (intersectRayWithNode(&r, &(children->_nodes[0])) != INFINITY) {
+        stack[stack_pointer++] = &(children->_nodes[0]);
+      }
+    }
+    if (stack_pointer == 0) {
+      return false;
+    }
+    node = stack[--stack_pointer];
+  }
+}
+
+
+
+//* bounds the slab interval of every ray in the packet at once, a miss here is a miss for all of them
+template <typename T> T intersectPacketWithNode(geo::rayPacket<T>* p, const geo::BVHCompactNode* b) {
+  T tmin = -INFINITY;
+  T tmax = INFINITY;
+  for (int axis = 0; axis < 3; axis++) {
+    if (!p->_bounded[axis]) { continue; }
+    T near_offset = (T)b->_bbmin[axis] - p->_O[axis];
+    T far_offset = (T)b->_bbmax[axis] - p->_O[axis];
+    T t1 = near_offset * p->_invD_min[axis];
+    T t2 = near_offset * p->_invD_max[axis];
+    T t3 = far_offset * p->_invD_min[axis];
+    T t4 = far_offset * p->_invD_max[axis];
+    tmin = std::max(tmin, std::min({t1, t2, t3, t4}));
+    tmax = std::min(tmax, std::max({t1, t2, t3, t4}));
+  }
+  if (tmax >= tmin && tmin < p->_t_max && tmax > 0.0) return tmin; else return INFINITY;
+}
+
+//* rays of the mask that may enter the node, once one ray hits the rest are carried down untested
+template <typename T> unsigned int packetNodeMask(geo::rayPacket<T>* p, const geo::BVHCompactNode* b, unsigned int mask) {
+  for (unsigned int i = 0; i < p->_N; i++) {
+    unsigned int bit = 1u << i;
+    if (!(mask & bit)) { continue; }
+    if (intersectRayWithNode(&(p->_rays[i]), b) != INFINITY) {
+      return mask & ~(bit - 1);
+    }
+  }
+  return 0;
+}
+
+//* returns the mask of rays in the packet that were blocked
+template <typename T> unsigned int intersectPacketWithCompactBVH(geo::rayPacket<T>* p, const geo::BVH<T>& bvh, simd::Level level, unsigned long long* mismatches) {
+  const geo::BVHCompactPair* pairs = bvh._pairs;
+  const geo::BVHCompactNode* node = &(pairs[0]._nodes[0]);
+  std::array<std::pair<const geo::BVHCompactNode*, unsigned int>, geo::BVH_MAX_DEPTH> stack;
+  unsigned int stack_pointer = 0;
+
+  unsigned int active = p->fullMask();
+  unsigned int mask = active;
+
+  while (1) {
+    if (node->isLeaf()) {
+      for (unsigned int i = 0; i < p->_N; i++) {
+        unsigned int bit = 1u << i;
+        if (!(mask & active & bit)) { continue; }
+        geo::ray<T>* r = &(p->_rays[i]);
+        if (intersectRayWithNode(r, node) == INFINITY) { continue; }
+        if (intersectRayWithLeaf(r, bvh, node, level, mismatches) < p->_lengths[i]) {
+          active &= ~bit;
+        }
+      }
+      if (active == 0 || stack_pointer == 0) {
         break;
       } else {
-        node = stack[--stack_pointer];
+        std::tie(node, mask) = stack[--stack_pointer];
       }
       continue;
     }
-    unsigned int child_index = node->childIndex();
-    geo::BVHNode<T>* child_one = bvh[child_index];
-    geo::BVHNode<T>* child_two = bvh[child_index + 1];
+    const geo::BVHCompactPair* children = &(pairs[node->childIndex()]);
+    const geo::BVHCompactNode* child_one = &(children->_nodes[0]);
+    const geo::BVHCompactNode* child_two = &(children->_nodes[1]);
 
-    T distance_one = intersectRayWithNode(r, child_one);
-    T distance_two = intersectRayWithNode(r, child_two);
+    T distance_one = intersectPacketWithNode(p, child_one);
+    T distance_two = intersectPacketWithNode(p, child_two);
+    unsigned int mask_one = (distance_one == INFINITY) ? 0 : packetNodeMask(p, child_one, mask & active);
+    unsigned int mask_two = (distance_two == INFINITY) ? 0 : packetNodeMask(p, child_two, mask & active);
+    if (mask_one == 0) { distance_one = INFINITY; }
+    if (mask_two == 0) { distance_two = INFINITY; }
 
     if (distance_one > distance_two) {
       std::swap(distance_one, distance_two);
       std::swap(child_one, child_two);
+      std::swap(mask_one, mask_two);
     }
     if (distance_one == INFINITY) {
       if (stack_pointer == 0) {
         break;
       } else {
-        node = stack[--stack_pointer];
+        std::tie(node, mask) = stack[--stack_pointer];
       }
     } else {
       node = child_one;
+      mask = mask_one;
       if (distance_two != INFINITY) {
-          stack[stack_pointer++] = child_two;
+          stack[stack_pointer++] = {child_two, mask_two};
       }
     }
   }
+  return p->fullMask() & ~active;
 }
 
 
 
-template <typename T> void bvhBlockingBetweenMeshes(geo::BVH<T>* bvh, geo::mesh<T>* blocking_mesh, std::vector<geo::v3<T>>* e_centroids, std::vector<geo::tri<T>>* r_triangles, std::vector<std::vector<unsigned int>*>* unculled_indices) {
-  unsigned int problem_size = e_centroids->size() * r_triangles->size();
+template <typename T, typename V> blockingStats bvhBlockingBetweenMeshes(geo::BVH<T>* bvh, const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, sparse::csr<V>* matrix, simd::Level level, bool validate) {
+  std::vector<unsigned char> blocked(matrix->nnz(), 0);
+  blockingStats stats;
+  stats._rays_cast = matrix->nnz();
+  unsigned long long* mismatches = validate ? &(stats._leaf_mismatches) : nullptr;
 
-  #pragma omp parallel for
-  for (int e = 0; e < unculled_indices->size(); e++) {
-    std::vector<unsigned int>* sub_indices = (*unculled_indices)[e];
-    for (int i = 0; i < sub_indices->size(); i++) {
-      unsigned int r = (*sub_indices)[i];
+  stats._rays_terminated = forEachTile(matrix, [&](unsigned int e, size_t begin, size_t end) -> unsigned long long {
+    const unsigned int* columns = matrix->rowColumns(e);
+    unsigned char* row_blocked = blocked.data() + matrix->_row_offsets[e];
+    unsigned long long terminated = 0;
+    for (size_t i = begin; i < end; i++) {
+      if (occluded(*bvh, e_data->centroid(e), r_data->centroid(columns[i]), level, mismatches)) {
+        row_blocked[i] = 1;
+        terminated++;
+      }
+    }
+    return terminated;
+  });
+  matrix->removeEntries(blocked);
+  return stats;
+}
 
-      geo::v3<T> e_centroid = (*e_centroids)[e];
-      geo::tri<T> r_tri = (*r_triangles)[r];
-      geo::v3<T> r_centroid = geo::centroid(r_tri);
 
-      geo::v3<T> ray_vector = r_centroid - e_centroid;
-      T ray_length = geo::magnitude(ray_vector);
-      geo::ray<T> cast_ray( e_centroid, geo::normalize(ray_vector) );
+//* rays from one emitter share an origin, so consecutive receivers of a tile are traced as packets
+template <typename T, typename V> blockingStats bvhPacketBlockingBetweenMeshes(geo::BVH<T>* bvh, const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, sparse::csr<V>* matrix, simd::Level level, bool validate) {
+  std::vector<unsigned char> blocked(matrix->nnz(), 0);
+  blockingStats stats;
+  stats._rays_cast = matrix->nnz();
+  unsigned long long* mismatches = validate ? &(stats._leaf_mismatches) : nullptr;
+
+  stats._rays_terminated = forEachTile(matrix, [&](unsigned int e, size_t begin, size_t end) -> unsigned long long {
+    const unsigned int* columns = matrix->rowColumns(e);
+    unsigned char* row_blocked = blocked.data() + matrix->_row_offsets[e];
+    geo::v3<T> e_centroid = e_data->centroid(e);
+    unsigned long long terminated = 0;
+
+    for (size_t first = begin; first < end; first += geo::PACKET_SIZE) {
+      unsigned int count = std::min(end - first, (size_t)geo::PACKET_SIZE);
+      geo::rayPacket<T> packet(e_centroid);
+      for (size_t i = first; i < first + count; i++) {
+        geo::v3<T> ray_vector = r_data->centroid(columns[i]) - e_centroid;
+        packet.add( geo::normalize(ray_vector), geo::magnitude(ray_vector) );
+      }
 
-      intersectRayWithBVH(&cast_ray, *bvh, blocking_mesh, ray_length);
-      bool blocked = ( cast_ray._t < ray_length );
-      if (blocked) {
-        (*sub_indices)[i] = problem_size;
+      unsigned int packet_blocked = intersectPacketWithCompactBVH(&packet, *bvh, level, mismatches);
+      for (unsigned int i = 0; i < count; i++) {
+        if (packet_blocked & (1u << i)) {
+          row_blocked[first + i] = 1;
+          terminated++;
+        }
+      }
+    }
+    return terminated;
+  });
+  matrix->removeEntries(blocked);
+  return stats;
+}
+
+//* runs a blocking stage only on the pairs the cache cannot answer and records what it finds. canonical pairs
+//* are cast first so their mirrors in the same tile come from the cache, the rest are cast as stored. the tile's
+//* rows are global rows first_row onward
+template <typename V, typename F> blockingStats cachedBlocking(sparse::csr<V>* matrix, unsigned int first_row, visibilityCache* cache, F block) {
+  blockingStats stats;
+  stats._cache_queries = matrix->nnz();
+
+  for (int pass = 0; pass < (cache->_unordered ? 2 : 1); pass++) {
+    sparse::csr<V> pending(matrix->_N_rows, matrix->_N_cols);
+    auto casts = [&](unsigned int e, unsigned int r) {
+      unsigned int e_global = first_row + e;
+      return ( cache->canonical(e_global, r) == (pass == 0) && cache->lookup(e_global, r) == VISIBILITY_UNKNOWN );
+    };
+    #pragma omp parallel for schedule(dynamic)
+    for (int e = 0; e < matrix->_N_rows; e++) {
+      pending._row_offsets[e + 1] = std::count_if(matrix->rowColumns(e), matrix->rowColumns(e) + matrix->rowSize(e), [&](unsigned int r) { return casts(e, r); });
+    }
+    pending.allocateFromCounts();
+    #pragma omp parallel for schedule(dynamic)
+    for (int e = 0; e < matrix->_N_rows; e++) {
+      std::copy_if(matrix->rowColumns(e), matrix->rowColumns(e) + matrix->rowSize(e), pending.rowColumns(e), [&](unsigned int r) { return casts(e, r); });
+    }
+
+    //* the stage drops blocked pairs from the pattern, whatever it kept was clear
+    sparse::csr<V> cast = pending;
+    stats += block(&pending);
+    #pragma omp parallel for schedule(dynamic)
+    for (int e = 0; e < cast._N_rows; e++) {
+      const unsigned int* kept = pending.rowColumns(e);
+      const unsigned int* kept_end = kept + pending.rowSize(e);
+      for (size_t k = 0; k < cast.rowSize(e); k++) {
+        unsigned int r = cast.rowColumns(e)[k];
+        bool clear = (kept != kept_end && *kept == r);
+        if (clear) { kept++; }
+        cache->store(first_row + e, r, !clear);
       }
     }
-    auto it = std::remove(sub_indices->begin(), sub_indices->end(), problem_size);
-    sub_indices->erase(it, sub_indices->end());
   }
+
+  std::vector<unsigned char> blocked(matrix->nnz(), 0);
+  #pragma omp parallel for schedule(dynamic)
+  for (int e = 0; e < matrix->_N_rows; e++) {
+    for (size_t k = matrix->_row_offsets[e]; k < matrix->_row_offsets[e + 1]; k++) {
+      blocked[k] = ( cache->lookup(first_row + e, matrix->_col_indices[k]) == VISIBILITY_BLOCKED );
+    }
+  }
+  matrix->removeEntries(blocked);
+  stats._cache_hits = stats._cache_queries - stats._rays_cast;
+  return stats;
 }
 
 
@@ -243,29 +805,61 @@ template <typename T> T singleAreaIntegration(geo::v3<T> e_centroid, geo::v3<T>
 }
 
 
-template <typename T> void viewFactors(std::vector<geo::v3<T>>* e_centroids, std::vector<geo::v3<T>>* e_normals, std::vector<geo::tri<T>>* r_triangles, std::vector<std::vector<unsigned int>*>* unculled_indices, std::vector<std::vector<T>*>* view_factors, std::string solver_mode) {
-  for (int e = 0; e < e_centroids->size(); e++) {
-
-    std::vector<unsigned int>* sub_indices = (*unculled_indices)[e];
-    std::vector<T>* sub_results = (*view_factors)[e];
-
-    #pragma omp parallel for
-    for (int i = 0; i < sub_indices->size(); i++) {
+//* pair kernel for one numerics mode, resolved at compile time so the pair loop carries no branch on it
+template <typename T, cli::NumericMode MODE> T viewFactor(geo::v3<T> e_centroid, geo::v3<T> e_normal, const geo::meshData<T>* r_data, unsigned int r) {
+  if constexpr (MODE == cli::NumericMode::DAI) {
+    return doubleAreaIntegration( e_centroid, e_normal, r_data->centroid(r), r_data->normal(r), r_data->_area[r] );
+  } else {
+    return singleAreaIntegration( e_centroid, e_normal, r_data->vertex(r, 0), r_data->vertex(r, 1), r_data->vertex(r, 2) );
+  }
+}
 
-      unsigned int r = (*sub_indices)[i];
-      geo::tri<T> r_triangle = (*r_triangles)[r];
+//* vector kernel over a run of one row, returns how many leading entries it filled, the rest are left to the scalar kernel
+template <typename T, cli::NumericMode MODE> size_t viewFactorRow(geo::v3<T> e_centroid, geo::v3<T> e_normal, const geo::meshData<T>* r_data, const unsigned int* columns, size_t count, T* values, simd::Level level) {
+#ifdef OVF_X86_SIMD
+  if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+    if constexpr (MODE == cli::NumericMode::DAI) {
+      if (level == simd::AVX512) { return simd::daiRowAVX512(e_centroid, e_normal, r_data, columns, count, values); }
+      if (level == simd::AVX2) { return simd::daiRowAVX2(e_centroid, e_normal, r_data, columns, count, values); }
+    } else {
+      if (level == simd::AVX512) { return simd::saiRowAVX512(e_centroid, e_normal, r_data, columns, count, values); }
+      if (level == simd::AVX2) { return simd::saiRowAVX2(e_centroid, e_normal, r_data, columns, count, values); }
+    }
+  }
+#endif
+  return 0;
+}
 
-      if (solver_mode == "DAI") {
+//* returns the largest deviation of the vector kernel from the scalar one when validating, zero otherwise, measured
+//* against the largest scalar value of the same row segment since near-zero SAI entries are mostly cancellation noise
+template <typename T, cli::NumericMode MODE> double viewFactors(const geo::meshData<T>* e_data, const geo::meshData<T>* r_data, sparse::csr<T>* matrix, simd::Level level, bool validate) {
+  matrix->_values.resize(matrix->nnz());
+  double max_deviation = 0.0;
+
+  forEachTile(matrix, [&](unsigned int e, size_t begin, size_t end) -> unsigned long long {
+    const unsigned int* columns = matrix->rowColumns(e);
+    T* values = matrix->rowValues(e);
+    geo::v3<T> e_centroid = e_data->centroid(e);
+    geo::v3<T> e_normal = e_data->normal(e);
+    size_t vectorized = begin + viewFactorRow<T, MODE>( e_centroid, e_normal, r_data, columns + begin, end - begin, values + begin, level );
+    for (size_t i = vectorized; i < end; i++) {
+      values[i] = viewFactor<T, MODE>( e_centroid, e_normal, r_data, columns[i] );
+    }
 
-        (*sub_results)[i] = doubleAreaIntegration( (*e_centroids)[e], (*e_normals)[e], geo::centroid(r_triangle), geo::normal(r_triangle), geo::area(r_triangle) );
-  
-      } else if (solver_mode == "SAI") {
-  
-        (*sub_results)[i] = singleAreaIntegration( (*e_centroids)[e], (*e_normals)[e], r_triangle[0], r_triangle[1], r_triangle[2] );
-  
+    if (validate) {
+      double difference = 0.0, scale = std::numeric_limits<double>::min();
+      for (size_t i = begin; i < vectorized; i++) {
+        T reference = viewFactor<T, MODE>( e_centroid, e_normal, r_data, columns[i] );
+        difference = std::max( difference, (double)std::abs(values[i] - reference) );
+        scale = std::max( scale, (double)std::abs(reference) );
       }
+      double deviation = difference / scale;
+      #pragma omp critical
+      max_deviation = std::max(max_deviation, deviation);
     }
-  }
+    return 0;
+  });
+  return max_deviation;
 }
   
   
@@ -0,0 +1,103 @@
+#include "all_headers.hpp"
+
+#pragma once
+
+//! ----- SPARSE MATRICES ----- !//
+
+namespace sparse {
+
+//* compressed sparse row matrix, row i owns entries [_row_offsets[i], _row_offsets[i+1]) of the column and value arrays
+template <typename T> class csr {
+  public:
+  unsigned int _N_rows;
+  unsigned int _N_cols;
+  std::vector<size_t> _row_offsets;
+  std::vector<unsigned int> _col_indices;
+  std::vector<T> _values;
+
+  csr() : _N_rows(0), _N_cols(0), _row_offsets(1, 0) {}
+  csr(unsigned int N_rows, unsigned int N_cols) : _N_rows(N_rows), _N_cols(N_cols), _row_offsets(N_rows + 1, 0) {}
+
+  size_t nnz() const { return _row_offsets.back(); }
+  size_t rowSize(unsigned int row) const { return _row_offsets[row + 1] - _row_offsets[row]; }
+
+  unsigned int* rowColumns(unsigned int row) { return _col_indices.data() + _row_offsets[row]; }
+  const unsigned int* rowColumns(unsigned int row) const { return _col_indices.data() + _row_offsets[row]; }
+  T* rowValues(unsigned int row) { return _values.data() + _row_offsets[row]; }
+  const T* rowValues(unsigned int row) const { return _values.data() + _row_offsets[row]; }
+
+  //* turns per-row counts stored in _row_offsets[1..N_rows] into offsets and sizes the column array
+  void allocateFromCounts() {
+    std::inclusive_scan(_row_offsets.begin() + 1, _row_offsets.end(), _row_offsets.begin() + 1);
+    _col_indices.resize(nnz());
+  }
+
+  //* every column present in every row
+  void fillDense() {
+    for (unsigned int row = 0; row < _N_rows; row++) {
+      _row_offsets[row + 1] = (size_t)(row + 1) * _N_cols;
+    }
+    _col_indices.resize(nnz());
+    #pragma omp parallel for
+    for (int row = 0; row < _N_rows; row++) {
+      std::iota(rowColumns(row), rowColumns(row) + _N_cols, 0);
+    }
+  }
+
+  //* the upper triangle of a square matrix, rows are global rows first_row + row and only hold the columns after it
+  void fillUpper(unsigned int first_row) {
+    for (unsigned int row = 0; row < _N_rows; row++) {
+      _row_offsets[row + 1] = _row_offsets[row] + (_N_cols - std::min(_N_cols, first_row + row + 1));
+    }
+    _col_indices.resize(nnz());
+    #pragma omp parallel for
+    for (int row = 0; row < _N_rows; row++) {
+      std::iota(rowColumns(row), rowColumns(row) + rowSize(row), first_row + row + 1);
+    }
+  }
+
+  //* sum of the stored values of each row, zeros never visited
+  std::vector<T> rowSums() const {
+    std::vector<T> sums(_N_rows);
+    #pragma omp parallel for schedule(dynamic)
+    for (int row = 0; row < _N_rows; row++) {
+      sums[row] = std::accumulate(rowValues(row), rowValues(row) + rowSize(row), (T)0.0);
+    }
+    return sums;
+  }
+
+  //* adds the stored values of each column onto sums, visiting rows in order like the transposed row sums do
+  void addColumnSums(std::vector<T>* sums) const {
+    for (size_t k = 0; k < nnz(); k++) {
+      (*sums)[ _col_indices[k] ] += _values[k];
+    }
+  }
+
+  //* drops every pattern entry flagged nonzero in removed (indexed like the column array), keeping column order
+  //* in each row, only meant for the pattern before any values are assigned
+  void removeEntries(const std::vector<unsigned char>& removed) {
+    std::vector<size_t> row_offsets(_N_rows + 1, 0);
+    #pragma omp parallel for schedule(dynamic)
+    for (int row = 0; row < _N_rows; row++) {
+      size_t kept = 0;
+      for (size_t k = _row_offsets[row]; k < _row_offsets[row + 1]; k++) {
+        if (!removed[k]) {
+          _col_indices[_row_offsets[row] + kept++] = _col_indices[k];
+        }
+      }
+      row_offsets[row + 1] = kept;
+    }
+    std::inclusive_scan(row_offsets.begin() + 1, row_offsets.end(), row_offsets.begin() + 1);
+
+    std::vector<unsigned int> col_indices(row_offsets.back());
+    #pragma omp parallel for schedule(dynamic)
+    for (int row = 0; row < _N_rows; row++) {
+      std::copy(rowColumns(row), rowColumns(row) + (row_offsets[row + 1] - row_offsets[row]), col_indices.data() + row_offsets[row]);
+    }
+    _row_offsets = std::move(row_offsets);
+    _col_indices = std::move(col_indices);
+    _values.clear();
+  }
+};
+
+}
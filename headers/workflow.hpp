@@ -28,7 +28,32 @@ public:
   }
 };
 
-template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
+//* pairs a solver stage pushed through per second, the figure the tiling is tuned against
+void logThroughput(std::vector<std::string>* log_messages, const std::string& stage, unsigned long long pairs, double seconds) {
+  double pairs_per_second = (seconds > 0.0) ? pairs / seconds : 0.0;
+  std::cout << "[LOG] " << stage << " throughput: " << pairs << " pairs at " << pairs_per_second << " [pairs/s]\n";
+  log_messages->push_back(std::string("[LOG] " + stage + " throughput: " + std::to_string(pairs) + " pairs at " + std::to_string(pairs_per_second) + " [pairs/s]\n"));
+}
+
+//* degenerate triangles dropped while reading a mesh, they would otherwise divide by a zero area
+void logDegenerateElements(std::vector<std::string>* log_messages, unsigned int num_degenerate) {
+  std::string log_degenerate = "[LOG] Removed " + std::to_string(num_degenerate) + " degenerate elements\n";
+  std::cout << log_degenerate;
+  log_messages->push_back(log_degenerate);
+}
+
+//* floating point types of the solver stages, geometry covers the meshes and the back-face cull, traversal the blocking
+//* mesh, its BVH and the rays cast through it, accumulation the view factor integration and the reductions over the matrix
+template <typename G, typename B = G, typename A = G> struct precisionPolicy {
+  using geometry_type = G;
+  using traversal_type = B;
+  using accumulation_type = A;
+};
+
+template <typename P> void ovfWorkflow(cli::po::variables_map variables_map) {
+  using T = typename P::geometry_type;
+  using B = typename P::traversal_type;
+  using A = typename P::accumulation_type;
 
   bool write_log = false;
   if ( variables_map["logfile"].as<std::string>() != "NONE" ) {
@@ -44,31 +69,59 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
 
   std::string back_face_cull_mode = variables_map["backfacecull"].as<std::string>();
   std::string blocking_type = variables_map["blockingtype"].as<std::string>();
+  std::string bvh_build_type = variables_map["bvhbuild"].as<std::string>();
+  std::string bvh_threading = variables_map["bvhthreading"].as<std::string>();
+  std::string leaf_kernel = variables_map["leafkernel"].as<std::string>();
+  std::string vf_kernel = variables_map["vfkernel"].as<std::string>();
   std::string self_int_type = variables_map["selfint"].as<std::string>();
   std::string numeric = variables_map["numerics"].as<std::string>();
   std::string compute = variables_map["compute"].as<std::string>();
   std::string precision = variables_map["precision"].as<std::string>();
+  std::string storage = variables_map["storage"].as<std::string>();
+  unsigned int emitter_tile = variables_map["emittertile"].as<unsigned int>();
+  double weld_tolerance = variables_map["weld"].as<double>();
 
   std::string load_back_face_cull = "[LOG] Solver Setting Loaded: Back Face Cull Mode\t-" + back_face_cull_mode + '\n';
   std::string load_blocking_mode = "[LOG] Solver Setting Loaded: Blocking Mode\t\t-" + blocking_type + '\n';
+  std::string load_bvh_build = "[LOG] Solver Setting Loaded: BVH Construction\t-" + bvh_build_type + '\n';
+  std::string load_bvh_threading = "[LOG] Solver Setting Loaded: BVH Threading\t\t-" + bvh_threading + '\n';
+  std::string load_leaf_kernel = "[LOG] Solver Setting Loaded: BVH Leaf Kernel\t\t-" + leaf_kernel + '\n';
+  std::string load_vf_kernel = "[LOG] Solver Setting Loaded: View Factor Kernel\t-" + vf_kernel + '\n';
   std::string load_selfint = "[LOG] Solver Setting Loaded: Self-Intersection Mode\t-" + self_int_type + '\n';
   std::string load_numeric = "[LOG] Solver Setting Loaded: Numeric Method\t\t-" + numeric + '\n';
   std::string load_compute = "[LOG] Solver Setting Loaded: Compute Backend\t\t-" + compute + '\n';
   std::string load_precision = "[LOG] Solver Setting Loaded: Floating Point Precision\t-" + precision + '\n';
+  std::string load_storage = "[LOG] Solver Setting Loaded: Matrix Storage\t\t-" + storage + '\n';
+  std::string load_emitter_tile = "[LOG] Solver Setting Loaded: Emitter Tile Size\t-" + ((emitter_tile == 0) ? std::string("NONE") : std::to_string(emitter_tile)) + '\n';
+  std::string load_weld = "[LOG] Solver Setting Loaded: Weld Tolerance\t\t-" + ((weld_tolerance == 0.0) ? std::string("EXACT") : std::to_string(weld_tolerance)) + '\n';
 
   std::cout << load_back_face_cull;
   std::cout << load_blocking_mode;
+  std::cout << load_bvh_build;
+  std::cout << load_bvh_threading;
+  std::cout << load_leaf_kernel;
+  std::cout << load_vf_kernel;
   std::cout << load_selfint;
   std::cout << load_numeric;
   std::cout << load_compute;
   std::cout << load_precision;
+  std::cout << load_storage;
+  std::cout << load_emitter_tile;
+  std::cout << load_weld;
 
   log_messages.push_back(load_back_face_cull);
   log_messages.push_back(load_blocking_mode);
+  log_messages.push_back(load_bvh_build);
+  log_messages.push_back(load_bvh_threading);
+  log_messages.push_back(load_leaf_kernel);
+  log_messages.push_back(load_vf_kernel);
   log_messages.push_back(load_selfint);
   log_messages.push_back(load_numeric);
   log_messages.push_back(load_compute);
   log_messages.push_back(load_precision);
+  log_messages.push_back(load_storage);
+  log_messages.push_back(load_emitter_tile);
+  log_messages.push_back(load_weld);
 
   std::cout << '\n';
 
@@ -79,6 +132,8 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
   std::string bvh_outfile = variables_map["bvhout"].as<std::string>();
   std::string bvh_output_filename;
   std::string matrix_outfile = variables_map["matrixout"].as<std::string>();
+  std::string bvh_cachefile = variables_map["bvhcache"].as<std::string>();
+  std::string visibility_outfile = variables_map["viscache"].as<std::string>();
   std::vector<std::string> graphic_outfiles = variables_map["graphicout"].as<std::vector<std::string>>();
   int num_graphic_outfiles = graphic_outfiles.size();
   std::string emitter_output_filename, receiver_output_filename, unified_output_filename;
@@ -102,14 +157,41 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
 
 
   std::string log_matrix_output;
+  std::string matrix_output_filename;
   if (write_matrix) {
-    std::string matrix_output_filename = matrix_outfile + ".ovf";
-    log_matrix_output = "[LOG] Plain Text Matrix Output Path : " + matrix_output_filename + '\n';
+    matrix_output_filename = matrix_outfile + ".ovf";
+    log_matrix_output = "[LOG] Binary Matrix Output Path : " + matrix_output_filename + '\n';
   } else {
-    log_matrix_output = "[LOG] NO Plain Text Matrix Output\n";
+    log_matrix_output = "[LOG] NO Binary Matrix Output\n";
   }
   std::cout << log_matrix_output;
   log_messages.push_back(log_matrix_output);
+
+
+  bool persist_bvh = (bvh_cachefile == "NONE") ? false : true;
+  std::string bvh_cache_filename;
+  std::string log_bvh_cache;
+  if (persist_bvh) {
+    bvh_cache_filename = bvh_cachefile + ".bvh";
+    log_bvh_cache = "[LOG] Blocker BVH Cache Path : " + bvh_cache_filename + '\n';
+  } else {
+    log_bvh_cache = "[LOG] NO Blocker BVH Cache File\n";
+  }
+  std::cout << log_bvh_cache;
+  log_messages.push_back(log_bvh_cache);
+
+
+  bool persist_visibility = (visibility_outfile == "NONE") ? false : true;
+  std::string visibility_filename;
+  std::string log_visibility_output;
+  if (persist_visibility) {
+    visibility_filename = visibility_outfile + ".vis";
+    log_visibility_output = "[LOG] Visibility Cache Path : " + visibility_filename + '\n';
+  } else {
+    log_visibility_output = "[LOG] NO Visibility Cache File\n";
+  }
+  std::cout << log_visibility_output;
+  log_messages.push_back(log_visibility_output);
   
 
   std::string log_graphic_output;
@@ -151,11 +233,19 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
   }
   bool two_mesh_problem = (input_filenames.size() > 1) ? true : false;
 
+  //* reciprocity only relates the two halves of the matrix when a mesh sees itself
+  bool symmetric = (cli::STORAGE_INPUT_TO_ENUM[storage] == cli::StorageMode::SYMMETRIC);
+  std::string log_symmetric_two_meshes = "<-----> [NOTIFIER] Symmetric storage needs a single input mesh! The full matrix will be solved\n";
+  if (symmetric && two_mesh_problem) {
+    std::cout << log_symmetric_two_meshes;
+    log_messages.push_back(log_symmetric_two_meshes);
+    symmetric = false;
+  }
+
 
   Timer loading_meshes_timer;
 
-  geometry::mesh<T> blocking_mesh;
-  geometry::mesh<T> new_blocking_mesh;
+  geometry::mesh<B> blocking_mesh;
   geometry::mesh<T> e_mesh;
   geometry::mesh<T> r_mesh;
 
@@ -164,7 +254,9 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
   
   std::cout << "[LOG] Loading Emitting Mesh : " << input_filenames[0] << '\n';
   log_messages.push_back(std::string("[LOG] Loading Emitting Mesh : " + input_filenames[0] + '\n'));
-  e_mesh = geometry::getMesh<T>( input_filenames[0] );
+  unsigned int num_degenerate = 0;
+  e_mesh = geometry::getMesh<T>( input_filenames[0], &num_degenerate );
+  logDegenerateElements(&log_messages, num_degenerate);
 
   io::printMeshMetrics(&e_mesh);
   io::logMeshMetrics(&log_messages, &e_mesh);
@@ -172,7 +264,8 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
   if (two_mesh_problem) {
     std::cout << "[LOG] Loading Receiving Mesh : " << input_filenames[1] << '\n';
     log_messages.push_back(std::string("[LOG] Loading Receiving Mesh : " + input_filenames[1] + '\n'));
-    r_mesh = geometry::getMesh<T>( input_filenames[1] );
+    r_mesh = geometry::getMesh<T>( input_filenames[1], &num_degenerate );
+    logDegenerateElements(&log_messages, num_degenerate);
     io::printMeshMetrics(&r_mesh);
     io::logMeshMetrics(&log_messages, &r_mesh);
   } else {
@@ -181,12 +274,18 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
 
   std::string log_blocking_mesh;
   if (blocking_enabled) {
+    std::vector<geometry::mesh<B>> blocker_meshes;
     for (auto file : blocker_filenames) {
       std::cout << "[LOG] Loading Blocking Mesh : " << file << '\n';
       log_messages.push_back(std::string("[LOG] Loading Blocking Mesh : " + file + '\n'));
-      new_blocking_mesh = geometry::getMesh<T>( file );
-      blocking_mesh = blocking_mesh + &new_blocking_mesh;
+      blocker_meshes.push_back( geometry::getMesh<B>( file, &num_degenerate ) );
+      logDegenerateElements(&log_messages, num_degenerate);
     }
+    std::vector<const geometry::mesh<B>*> blocking_parts;
+    for (const geometry::mesh<B>& part : blocker_meshes) {
+      blocking_parts.push_back(&part);
+    }
+    blocking_mesh = geometry::combineMeshes(blocking_parts);
     io::printMeshMetrics(&blocking_mesh);
   } else {
     std::cout << "[LOG] NO Blocking Meshes Loaded\n";
@@ -196,12 +295,33 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
   if (self_int_type == "EMITTER" || self_int_type == "BOTH") {
     std::cout << "[LOG] Adding Emitter Mesh to Blocking Structure\n";
     log_messages.push_back(std::string("[LOG] Adding Emitter Mesh to Blocking Structure\n"));
-    blocking_mesh = blocking_mesh + &e_mesh;
+    if constexpr (std::is_same_v<T, B>) {
+      blocking_mesh + &e_mesh;
+    } else {
+      geometry::mesh<B> e_blocking(&e_mesh);
+      blocking_mesh + &e_blocking;
+    }
   }
   if (self_int_type == "RECEIVER" || self_int_type == "BOTH") {
     std::cout << "[LOG] Adding Receiver Mesh to Blocking Structure\n";
     log_messages.push_back(std::string("[LOG] Adding Receiver Mesh to Blocking Structure\n"));
-    blocking_mesh = blocking_mesh + &r_mesh;
+    if constexpr (std::is_same_v<T, B>) {
+      blocking_mesh + &r_mesh;
+    } else {
+      geometry::mesh<B> r_blocking(&r_mesh);
+      blocking_mesh + &r_blocking;
+    }
+  }
+
+  //* welding never moves a vertex at zero tolerance, it only lets coincident corners share one stored vertex
+  if (blocking_mesh.size() > 0) {
+    geometry::weldStats weld = geometry::weldVertices(&blocking_mesh, (B)weld_tolerance);
+    std::string log_weld = "[LOG] Blocking mesh welded from " + std::to_string(weld._vertices_before) + " to " + std::to_string(weld._vertices_after) + " vertices, " + std::to_string(weld._collapsed) + " collapsed triangles dropped\n";
+    std::cout << log_weld;
+    log_messages.push_back(log_weld);
+    if (blocking_mesh.size() == 0) {
+      throw std::runtime_error("Welding collapsed every blocking triangle, lower the weld tolerance");
+    }
   }
 
   std::cout << "[LOG] Meshes loaded in " << loading_meshes_timer.elapsed() << " [s]\n";
@@ -219,17 +339,50 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
 
   Timer bvh_timer;
 
-  geometry::BVH<T> blocker(&blocking_mesh);
+  geometry::BVH<B> blocker(&blocking_mesh);
+
+  //* settings the solver branches on, resolved once from their strings
+  cli::BackFaceCullMode back_face_cull = cli::BACKFACECULL_INPUT_TO_ENUM[back_face_cull_mode];
+  cli::BlockingMode blocking = cli::BLOCKING_TYPE_INPUT_TO_ENUM[blocking_type];
+  cli::NumericMode numeric_mode = cli::NUMERICS_INPUT_TO_ENUM[numeric];
 
-  if (blocking_type == "BVH") {
+  bool use_bvh = (blocking == cli::BlockingMode::BVH || blocking == cli::BlockingMode::BVH_PACKET);
+
+  if (use_bvh) {
 
     if (blocking_enabled || self_int_type != "NONE") {
-      std::cout << "[LOG] Generating obstructing Boundary Volume Hierarchy (BVH)\n";
-      log_messages.push_back(std::string("[LOG] Generating obstructing Boundary Volume Hierarchy (BVH)\n"));
-      geometry::constructBVH(&blocker, &blocking_mesh);
+      uint64_t bvh_hash = 0;
+      bool bvh_loaded = false;
+      if (persist_bvh) {
+        bvh_hash = solver::bvhHash(&blocking_mesh, cli::BVH_CONSTRUCTION_INPUT_TO_ENUM[bvh_build_type]);
+        bvh_loaded = io::readBVHCache(bvh_cache_filename, bvh_hash, &blocker, &blocking_mesh);
+      }
+
+      if (bvh_loaded) {
+        std::cout << "[LOG] Loaded obstructing Boundary Volume Hierarchy (BVH) from " << bvh_cache_filename << '\n';
+        log_messages.push_back(std::string("[LOG] Loaded obstructing Boundary Volume Hierarchy (BVH) from " + bvh_cache_filename + '\n'));
+      } else {
+        std::cout << "[LOG] Generating obstructing Boundary Volume Hierarchy (BVH)\n";
+        log_messages.push_back(std::string("[LOG] Generating obstructing Boundary Volume Hierarchy (BVH)\n"));
+        bool parallel_build = (bvh_threading == "TASKS");
+        if (bvh_build_type == "SAMPLED") {
+          geometry::constructBVH(&blocker, &blocking_mesh, parallel_build);
+        } else if (bvh_build_type == "BINNED") {
+          geometry::constructBVHBinned(&blocker, &blocking_mesh, parallel_build);
+        }
+        if (persist_bvh) {
+          io::writeBVHCache(&blocker, bvh_hash, bvh_cache_filename);
+          std::cout << "[OUTPUT] Blocker BVH cached to " << bvh_cache_filename << '\n';
+          log_messages.push_back(std::string("[OUTPUT] Blocker BVH cached to " + bvh_cache_filename + '\n'));
+        }
+      }
       std::cout << "[LOG] BVH generated in " << bvh_timer.elapsed() << " [s]\n";
       std::cout << "[LOG] BVH Nodes Used = " << blocker._nodes_used << '\n';
+      std::cout << "[LOG] BVH SAH Cost = " << geometry::treeCost(&blocker) << '\n';
+      std::cout << "[LOG] BVH Depth = " << blocker._depth << '\n';
       log_messages.push_back(std::string("[LOG] BVH generated in " + std::to_string(bvh_timer.elapsed()) + " [s]\n" + "[LOG] BVH Nodes Used = " + std::to_string(blocker._nodes_used) + '\n'));
+      log_messages.push_back(std::string("[LOG] BVH SAH Cost = " + std::to_string(geometry::treeCost(&blocker)) + '\n'));
+      log_messages.push_back(std::string("[LOG] BVH Depth = " + std::to_string(blocker._depth) + '\n'));
       std::cout << '\n';
     }
     
@@ -247,66 +400,266 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
 
   Timer solver_timer;
 
-  std::vector<geometry::v3<T>> e_centroids = geometry::centroids(&e_mesh);
-  std::vector<geometry::v3<T>> e_normals = geometry::normals(&e_mesh);
+  geometry::meshData<T> e_data(&e_mesh);
+  geometry::meshData<T> r_data(&r_mesh);
+
+  //* integration reads its own wider copy of the element data when accumulating above the geometry precision
+  geometry::meshData<A> e_wide, r_wide;
+  const geometry::meshData<A>* e_values;
+  const geometry::meshData<A>* r_values;
+  if constexpr (std::is_same_v<T, A>) {
+    e_values = &e_data;
+    r_values = &r_data;
+  } else {
+    e_wide = geometry::meshData<A>(&e_data);
+    r_wide = geometry::meshData<A>(&r_data);
+    e_values = &e_wide;
+    r_values = &r_wide;
+  }
 
-  std::vector<geometry::v3<T>> r_centroids = geometry::centroids(&r_mesh);
-  std::vector<geometry::v3<T>> r_normals = geometry::normals(&r_mesh);
-  std::vector<geometry::tri<T>> r_triangles = geometry::allTriangles(&r_mesh);
+  //* rays are cast from a copy of the element data in the traversal type when it differs from the geometry type
+  geometry::meshData<B> e_cast, r_cast;
+  const geometry::meshData<B>* e_rays;
+  const geometry::meshData<B>* r_rays;
+  if constexpr (std::is_same_v<T, B>) {
+    e_rays = &e_data;
+    r_rays = &r_data;
+  } else {
+    if (blocking_enabled) {
+      e_cast = geometry::meshData<B>(&e_data);
+      r_cast = geometry::meshData<B>(&r_data);
+    }
+    e_rays = &e_cast;
+    r_rays = &r_cast;
+  }
 
-  std::vector<std::vector<unsigned int>*> unculled_indices(e_mesh.size());
-  for (int i = 0; i < e_mesh.size(); i++) {
-    std::vector<unsigned int>* sub_indices = new std::vector<unsigned int>(r_mesh.size());
-    std::iota(sub_indices->begin(), sub_indices->end(), 0);
-    unculled_indices[i] = sub_indices;
+  //* emitters are solved a tile of rows at a time, a streamed tile is written out and dropped before the next one
+  unsigned int N_e = e_mesh.size();
+  unsigned int N_r = r_mesh.size();
+  bool streaming = (emitter_tile != 0 && emitter_tile < N_e);
+  unsigned int tile_size = streaming ? emitter_tile : N_e;
+
+  sparse::csr<A> matrix;
+  std::vector<A> emitter_totals, receiver_totals;
+  uint32_t matrix_flags = symmetric ? io::MATRIX_UPPER_TRIANGULAR : 0;
+  if (symmetric) {
+    std::cout << "[LOG] Solving the upper triangle only, pairs i < j\n";
+    log_messages.push_back(std::string("[LOG] Solving the upper triangle only, pairs i < j\n"));
+  }
+  io::matrixWriter<A> matrix_writer;
+  if (streaming) {
+    unsigned int num_tiles = (N_e + tile_size - 1) / tile_size;
+    std::cout << "[LOG] Streaming " << num_tiles << " emitter tiles of " << tile_size << " elements\n";
+    log_messages.push_back(std::string("[LOG] Streaming " + std::to_string(num_tiles) + " emitter tiles of " + std::to_string(tile_size) + " elements\n"));
+    emitter_totals.assign(N_e, (A)0.0);
+    receiver_totals.assign(N_r, (A)0.0);
+    if (write_matrix) {
+      matrix_writer.open(matrix_output_filename, N_e, N_r, matrix_flags);
+    }
   }
 
-  if (back_face_cull_mode == "ON") {
+  bool culling = (back_face_cull != cli::BackFaceCullMode::OFF);
+  if (culling) {
     std::cout << "[LOG] Applying Back-Face Cull\n";
     log_messages.push_back(std::string("[LOG] Applying Back-Face Cull\n"));
+  }
 
-    solver::backFaceCullMeshes(&e_centroids, &e_normals, &r_centroids, &r_normals, &unculled_indices);
-
-    std::cout << "[LOG] Back-Face Cull completed in " << solver_timer.elapsed() << " [s]\n";
-    log_messages.push_back(std::string("[LOG] Back-Face Cull completed in " + std::to_string(solver_timer.elapsed()) + " [s]\n"));
-
+  //* the receiver clusters are shared by every emitter tile
+  geometry::clusterTree<T> r_clusters;
+  if (back_face_cull == cli::BackFaceCullMode::HIERARCHICAL) {
     solver_timer.reset();
+    r_clusters = geometry::clusterTree<T>(&r_data);
+    double cluster_time = solver_timer.elapsed();
+    std::cout << "[LOG] Receiver cluster tree of " << r_clusters._clusters.size() << " clusters built in " << cluster_time << " [s]\n";
+    log_messages.push_back(std::string("[LOG] Receiver cluster tree of " + std::to_string(r_clusters._clusters.size()) + " clusters built in " + std::to_string(cluster_time) + " [s]\n"));
   }
 
+  //* long double has no vector kernel, its leaves always take the scalar path
+  simd::Level leaf_level = simd::SCALAR;
+  bool validate = false;
   if (blocking_enabled) {
     std::cout << "[LOG] Applying Blocking\n";
     log_messages.push_back(std::string("[LOG] Applying Blocking\n"));
-  
-    if (blocking_type == "NAIVE") {
-      solver::naiveBlockingBetweenMeshes(&blocking_mesh, &e_centroids, &r_triangles, &unculled_indices);
-    } else if (blocking_type == "BVH") {
-      solver::bvhBlockingBetweenMeshes(&blocker, &blocking_mesh, &e_centroids, &r_triangles, &unculled_indices);
+    if (use_bvh) {
+      if (leaf_kernel != "SCALAR" && (std::is_same_v<B, float> || std::is_same_v<B, double>)) {
+        leaf_level = simd::detectLevel();
+      }
+      std::cout << "[LOG] BVH leaf kernel: " << simd::LEVEL_TO_OUTPUT[leaf_level] << '\n';
+      log_messages.push_back(std::string("[LOG] BVH leaf kernel: " + simd::LEVEL_TO_OUTPUT[leaf_level] + '\n'));
+      validate = (leaf_kernel == "VALIDATE" && leaf_level != simd::SCALAR);
     }
+  }
 
-    std::cout << "[LOG] Blocking completed in " << solver_timer.elapsed() << " [s]\n";
-    log_messages.push_back(std::string("[LOG] Blocking completed in " + std::to_string(solver_timer.elapsed()) + " [s]\n"));
-    solver_timer.reset();
+  //* the cache is dense, 2 bits for each of the N_e * N_r pairs (N (N + 1) / 2 for a single mesh) whatever survives
+  //* culling, so about 1.2 GiB at 100k elements. it is only built when asked to carry results across runs, and never
+  //* while streaming, where it would undo the memory bound of the tiles
+  bool cache_visibility = blocking_enabled && persist_visibility;
+  std::string log_visibility_streaming = "<-----> [NOTIFIER] The visibility cache holds every pair and is not kept while streaming emitter tiles! Blocking will not be cached\n";
+  if (cache_visibility && streaming) {
+    std::cout << log_visibility_streaming;
+    log_messages.push_back(log_visibility_streaming);
+    cache_visibility = false;
+  }
+  solver::visibilityCache visibility;
+  if (cache_visibility) {
+    visibility = solver::visibilityCache(N_e, N_r, !two_mesh_problem, solver::visibilityHash(&e_data, &r_data, &blocking_mesh, blocking));
+    std::cout << "[LOG] Visibility cache of " << visibility.bytes() << " [bytes] over " << visibility.numPairs() << " pairs\n";
+    log_messages.push_back(std::string("[LOG] Visibility cache of " + std::to_string(visibility.bytes()) + " [bytes] over " + std::to_string(visibility.numPairs()) + " pairs\n"));
+    if (persist_visibility) {
+      std::string log_visibility_load = io::readVisibilityCache(visibility_filename, &visibility)
+        ? "[LOG] Visibility cache loaded from " + visibility_filename + '\n'
+        : "[LOG] No visibility cache for this geometry in " + visibility_filename + ", starting empty\n";
+      std::cout << log_visibility_load;
+      log_messages.push_back(log_visibility_load);
+    }
   }
 
   std::cout << "[LOG] Evaluating View Factors\n";
   log_messages.push_back(std::string("[LOG] Evaluating View Factors\n"));
-  if (numeric == "DAI") {
+  if (numeric_mode == cli::NumericMode::DAI) {
     std::cout << "[LOG] Applying Double Area Integration\n";
     log_messages.push_back(std::string("[LOG] Applying Double Area Integration\n"));
-  } else if (numeric == "SAI") {
+  } else if (numeric_mode == cli::NumericMode::SAI) {
     std::cout << "[LOG] Applying Single Area Integration\n";
     log_messages.push_back(std::string("[LOG] Applying Single Area Integration\n"));
   }
-  
-  std::vector<std::vector<T>*> view_factors(e_mesh.size());
-  for (int i = 0; i < e_mesh.size(); i++) {
-    std::vector<T>* sub_results = new std::vector<T>( ( (unculled_indices)[i] )->size() );
-    view_factors[i] = sub_results;
+  simd::Level vf_level = simd::SCALAR;
+  if (vf_kernel != "SCALAR" && (std::is_same_v<A, float> || std::is_same_v<A, double>)) {
+    vf_level = simd::detectLevel();
   }
-  solver::viewFactors(&e_centroids, &e_normals, &r_triangles, &unculled_indices, &view_factors, numeric);
+  bool vf_validate = (vf_kernel == "VALIDATE" && vf_level != simd::SCALAR);
+  std::cout << "[LOG] View factor kernel: " << simd::LEVEL_TO_OUTPUT[vf_level] << '\n';
+  log_messages.push_back(std::string("[LOG] View factor kernel: " + simd::LEVEL_TO_OUTPUT[vf_level] + '\n'));
+
+  double cull_time = 0.0, blocking_time = 0.0, view_factor_time = 0.0;
+  unsigned long long cull_pairs = 0, cull_element_tests = 0, view_factor_pairs = 0;
+  solver::blockingStats blocking_stats;
+  double vf_deviation = 0.0;
+
+  for (unsigned int first = 0; first < N_e; first += tile_size) {
+    unsigned int last = std::min(first + tile_size, N_e);
+    geometry::meshData<T> tile_data = streaming ? e_data.slice(first, last) : geometry::meshData<T>();
+    const geometry::meshData<T>* tile_emitters = streaming ? &tile_data : &e_data;
+    geometry::meshData<A> tile_wide;
+    const geometry::meshData<A>* tile_values = e_values;
+    if (streaming) {
+      if constexpr (std::is_same_v<T, A>) {
+        tile_values = tile_emitters;
+      } else {
+        tile_wide = e_values->slice(first, last);
+        tile_values = &tile_wide;
+      }
+    }
+    geometry::meshData<B> tile_cast;
+    const geometry::meshData<B>* tile_rays = e_rays;
+    if (streaming) {
+      if constexpr (std::is_same_v<T, B>) {
+        tile_rays = tile_emitters;
+      } else if (blocking_enabled) {
+        tile_cast = e_rays->slice(first, last);
+        tile_rays = &tile_cast;
+      }
+    }
+    sparse::csr<A> tile(last - first, N_r);
+
+    solver_timer.reset();
+    if (back_face_cull == cli::BackFaceCullMode::ON) {
+      solver::backFaceCullMeshes(tile_emitters, &r_data, &tile, symmetric, first);
+    } else if (back_face_cull == cli::BackFaceCullMode::HIERARCHICAL) {
+      cull_element_tests += solver::hierarchicalCullMeshes(tile_emitters, &r_data, &r_clusters, &tile, symmetric, first);
+    } else if (symmetric) {
+      tile.fillUpper(first);
+    } else {
+      tile.fillDense();
+    }
+    cull_time += solver_timer.elapsed();
+    if (symmetric) {
+      //* rows first to last - 1 hold N_r - 1 - first down to N_r - last candidate columns
+      cull_pairs += (unsigned long long)(last - first) * (2ull * N_r - first - last - 1) / 2;
+    } else {
+      cull_pairs += (unsigned long long)(last - first) * N_r;
+    }
+
+    solver_timer.reset();
+    if (blocking_enabled) {
+      auto block = [&](sparse::csr<A>* pattern) -> solver::blockingStats {
+        if (blocking == cli::BlockingMode::NAIVE) {
+          return solver::naiveBlockingBetweenMeshes(&blocking_mesh, tile_rays, r_rays, pattern);
+        } else if (blocking == cli::BlockingMode::BVH_PACKET) {
+          return solver::bvhPacketBlockingBetweenMeshes(&blocker, tile_rays, r_rays, pattern, leaf_level, validate);
+        }
+        return solver::bvhBlockingBetweenMeshes(&blocker, tile_rays, r_rays, pattern, leaf_level, validate);
+      };
+      if (cache_visibility) {
+        blocking_stats += solver::cachedBlocking(&tile, first, &visibility, block);
+      } else {
+        blocking_stats += block(&tile);
+      }
+    }
+    blocking_time += solver_timer.elapsed();
 
-  std::cout << "[LOG] View Factors completed in " << solver_timer.elapsed() << " [s]\n";
-  log_messages.push_back(std::string("[LOG] View Factors completed in " + std::to_string(solver_timer.elapsed()) + " [s]\n"));
+    solver_timer.reset();
+    switch (numeric_mode) {
+      case cli::NumericMode::DAI:
+        vf_deviation = std::max(vf_deviation, solver::viewFactors<A, cli::NumericMode::DAI>(tile_values, r_values, &tile, vf_level, vf_validate));
+        break;
+      case cli::NumericMode::SAI:
+        vf_deviation = std::max(vf_deviation, solver::viewFactors<A, cli::NumericMode::SAI>(tile_values, r_values, &tile, vf_level, vf_validate));
+        break;
+    }
+    view_factor_time += solver_timer.elapsed();
+    view_factor_pairs += tile.nnz();
+
+    if (streaming) {
+      if (symmetric) {
+        results::addReciprocalTotals(&tile, first, &e_values->_area, &emitter_totals, &receiver_totals);
+      } else {
+        std::vector<A> tile_totals = tile.rowSums();
+        std::copy(tile_totals.begin(), tile_totals.end(), emitter_totals.begin() + first);
+        tile.addColumnSums(&receiver_totals);
+      }
+      if (write_matrix) {
+        matrix_writer.append(&tile);
+      }
+    } else {
+      matrix = std::move(tile);
+    }
+  }
+
+  if (culling) {
+    if (back_face_cull == cli::BackFaceCullMode::HIERARCHICAL) {
+      std::cout << "[LOG] Back-Face Cull tested " << cull_element_tests << " of " << cull_pairs << " pairs element by element\n";
+      log_messages.push_back(std::string("[LOG] Back-Face Cull tested " + std::to_string(cull_element_tests) + " of " + std::to_string(cull_pairs) + " pairs element by element\n"));
+    }
+    std::cout << "[LOG] Back-Face Cull completed in " << cull_time << " [s]\n";
+    log_messages.push_back(std::string("[LOG] Back-Face Cull completed in " + std::to_string(cull_time) + " [s]\n"));
+    logThroughput(&log_messages, "Back-Face Cull", cull_pairs, cull_time);
+  }
+
+  if (blocking_enabled) {
+    if (validate) {
+      std::cout << "[LOG] Leaf kernel validation: " << blocking_stats._leaf_mismatches << " leaf tests differ from the scalar kernel\n";
+      log_messages.push_back(std::string("[LOG] Leaf kernel validation: " + std::to_string(blocking_stats._leaf_mismatches) + " leaf tests differ from the scalar kernel\n"));
+    }
+    if (cache_visibility) {
+      double hit_rate = (blocking_stats._cache_queries > 0) ? 100.0 * blocking_stats._cache_hits / blocking_stats._cache_queries : 0.0;
+      std::cout << "[LOG] Visibility cache answered " << blocking_stats._cache_hits << " of " << blocking_stats._cache_queries << " pair queries (" << hit_rate << " [%]) from " << visibility.bytes() << " [bytes]\n";
+      log_messages.push_back(std::string("[LOG] Visibility cache answered " + std::to_string(blocking_stats._cache_hits) + " of " + std::to_string(blocking_stats._cache_queries) + " pair queries (" + std::to_string(hit_rate) + " [%]) from " + std::to_string(visibility.bytes()) + " [bytes]\n"));
+    }
+    std::cout << "[LOG] Blocking terminated " << blocking_stats._rays_terminated << " of " << blocking_stats._rays_cast << " rays at their first occluder\n";
+    log_messages.push_back(std::string("[LOG] Blocking terminated " + std::to_string(blocking_stats._rays_terminated) + " of " + std::to_string(blocking_stats._rays_cast) + " rays at their first occluder\n"));
+    std::cout << "[LOG] Blocking completed in " << blocking_time << " [s]\n";
+    log_messages.push_back(std::string("[LOG] Blocking completed in " + std::to_string(blocking_time) + " [s]\n"));
+    logThroughput(&log_messages, "Blocking", blocking_stats._rays_cast, blocking_time);
+  }
+
+  std::cout << "[LOG] View Factors completed in " << view_factor_time << " [s]\n";
+  log_messages.push_back(std::string("[LOG] View Factors completed in " + std::to_string(view_factor_time) + " [s]\n"));
+  logThroughput(&log_messages, "View Factors", view_factor_pairs, view_factor_time);
+  if (vf_validate) {
+    std::cout << "[LOG] View factor kernel validation: largest relative deviation from the scalar kernel " << vf_deviation << '\n';
+    log_messages.push_back(std::string("[LOG] View factor kernel validation: largest relative deviation from the scalar kernel " + std::to_string(vf_deviation) + '\n'));
+  }
 
   std::cout << '\n';
 
@@ -317,9 +670,15 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
   std::cout << "[LOG] Evaluating Results\n";
   log_messages.push_back(std::string("[LOG] Evaluating Results\n"));
 
-  results::solution<T> s(&unculled_indices, &view_factors, e_mesh.size(), r_mesh.size());
-  std::vector<T> e_areas = geometry::areas(&e_mesh);
-  T surface_to_surface_vf = results::surfaceVF(&s, &e_areas);
+  results::solution<A> s;
+  if (streaming) {
+    s = results::solution<A>(N_e, N_r, std::move(emitter_totals), std::move(receiver_totals));
+  } else if (symmetric) {
+    s = results::solution<A>(std::move(matrix), e_values->_area);
+  } else {
+    s = results::solution<A>(std::move(matrix));
+  }
+  A surface_to_surface_vf = results::surfaceVF(&s, &e_values->_area);
 
   std::cout << "[RESULT] Surface-Surface View Factor: " << std::setprecision(15) << surface_to_surface_vf << '\n';
   log_messages.push_back( std::format( "[RESULT] Surface-Surface View Factor: {}\n", surface_to_surface_vf) );
@@ -342,13 +701,25 @@ template <typename T> void ovfWorkflow(cli::po::variables_map variables_map) {
 
 
   if (write_matrix) {
-    std::cout << "[OUTPUT] Writing plain-text matrix output\n";
-    //TODO write plain-text output
+    std::cout << "[OUTPUT] Writing binary matrix output\n";
+    if (streaming) {
+      matrix_writer.close(&e_data._area, &r_data._area);
+    } else {
+      io::writeToFile(&s._matrix, &e_data._area, &r_data._area, matrix_output_filename, matrix_flags);
+    }
     std::cout << "[LOG] Results matrix written in " << output_timer.elapsed() << " [s]\n";
     output_timer.reset();
   }
 
 
+  if (cache_visibility) {
+    std::cout << "[OUTPUT] Writing visibility cache\n";
+    io::writeToFile(&visibility, visibility_filename);
+    std::cout << "[LOG] Visibility cache written in " << output_timer.elapsed() << " [s]\n";
+    output_timer.reset();
+  }
+
+
   if (write_graphic) {
     std::cout << "[OUTPUT] Writing Emitter .vtu file\n";
     io::writeToFile(&s, &e_mesh, &r_mesh, emitter_output_filename, io::VisualOutputMode::EMITTER);
@@ -55,7 +55,9 @@ void meshAnalysis(po::variables_map variables_map) {
   std::cout << '\n';
 
   std::cout << "[LOG] Loading Input Mesh : " << input_filename << '\n';
-  geometry::mesh<double> m = geometry::getMesh<double>( input_filename );
+  unsigned int num_degenerate = 0;
+  geometry::mesh<double> m = geometry::getMesh<double>( input_filename, &num_degenerate );
+  std::cout << "[LOG] Removed " << num_degenerate << " degenerate elements\n";
 
   io::printMeshMetrics(&m);
 
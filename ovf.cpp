@@ -23,9 +23,13 @@ int main(int argc, char *argv[]) {
   cli::po::notify(variables_map);
   std::string precision = variables_map["precision"].as<std::string>();
   if (precision == "SINGLE") {
-    workflow::ovfWorkflow<float>(variables_map);
+    workflow::ovfWorkflow<workflow::precisionPolicy<float>>(variables_map);
   } else if (precision == "DOUBLE") {
-    workflow::ovfWorkflow<long double>(variables_map);
+    workflow::ovfWorkflow<workflow::precisionPolicy<double>>(variables_map);
+  } else if (precision == "EXTENDED") {
+    workflow::ovfWorkflow<workflow::precisionPolicy<long double>>(variables_map);
+  } else if (precision == "MIXED") {
+    workflow::ovfWorkflow<workflow::precisionPolicy<float, float, double>>(variables_map);
   }
   return 0;
 }
\ No newline at end of file